@@ -16,12 +16,14 @@ static const float INV_SQRT2 = 0.70710678118654752440f;
 
 // --- Utility functions ---
 
-// Flush denormals to zero (prevents FPU slowdown on ARM)
+// Flush denormals to zero (prevents FPU slowdown on ARM). NaN and Inf are
+// zeroed too, so one bad input sample can't latch a filter's state.
 inline float flush_denormal(float x)
 {
     union { float f; uint32_t i; } u;
     u.f = x;
-    if ((u.i & 0x7F800000) == 0 && (u.i & 0x007FFFFF) != 0)
+    uint32_t e = u.i & 0x7F800000;
+    if ((e == 0 && (u.i & 0x007FFFFF) != 0) || e == 0x7F800000)
         u.f = 0.0f;
     return u.f;
 }
@@ -52,19 +54,154 @@ inline float voct_to_mult(float voltage)
     return powf(2.0f, voltage);
 }
 
+// Cutoff FM response
+enum FMMode
+{
+    FM_EXP = 0,       // exponential, 1V/oct
+    FM_LINEAR,        // linear in Hz, clamped at the bottom of the range
+    FM_THRU_ZERO,     // linear in Hz, through zero (see mode_thru_zero_sign)
+    NUM_FM_MODES
+};
+
+// Linear FM: fm volts (scaled by depth) deviate the cutoff by the cutoff
+// itself per volt, so the FM timbre follows V/OCT. No exp, and the result
+// can reach zero or below.
+inline float fm_linear(float cutoff_hz, float fm)
+{
+    return cutoff_hz + cutoff_hz * fm;
+}
+
+// Approximate 2^x: exponent bits plus a cubic for the fraction
+// (relative error < 2e-4, about 0.3 cents)
+inline float fast_exp2(float x)
+{
+    if (x < -126.0f) x = -126.0f;
+    if (x > 126.0f) x = 126.0f;
+    float fi = floorf(x);
+    float f = x - fi;
+    float p = 1.0f + f * (0.6959924f + f * (0.2249146f + f * 0.0790930f));
+    union { float f; int32_t i; } u;
+    u.i = ((int32_t)fi + 127) << 23;
+    return u.f * p;
+}
+
+// --- Parameter-domain tables ---
+// Cutoff and MIDI notes only take a small set of discrete values, so their
+// frequencies are generated at compile time (C++11 constexpr) and looked up
+// instead of calling powf.
+
+// Compile-time integer sequence 0..N-1 (std::index_sequence is C++14).
+// Built by halves so the template depth stays logarithmic in N.
+template <int... I> struct IndexSeq {};
+
+template <class A, class B> struct ConcatSeq;
+template <int... A, int... B>
+struct ConcatSeq<IndexSeq<A...>, IndexSeq<B...> >
+{
+    typedef IndexSeq<A..., (int)sizeof...(A) + B...> type;
+};
+
+template <int N> struct MakeSeq
+{
+    typedef typename ConcatSeq<typename MakeSeq<N / 2>::type,
+                               typename MakeSeq<N - N / 2>::type>::type type;
+};
+template <> struct MakeSeq<0> { typedef IndexSeq<> type; };
+template <> struct MakeSeq<1> { typedef IndexSeq<0> type; };
+
+// constexpr exp(): Taylor series on |x| <= 0.5, squared back up
+constexpr double const_exp_series(double x, double term, int n)
+{
+    return n > 16 ? term : term + const_exp_series(x, term * x / n, n + 1);
+}
+
+constexpr double const_square(double x)
+{
+    return x * x;
+}
+
+constexpr double const_exp(double x)
+{
+    return (x > 0.5 || x < -0.5) ? const_square(const_exp(x * 0.5))
+                                 : const_exp_series(x, 1.0, 1);
+}
+
+template <int N>
+struct FloatTable
+{
+    float v[N];
+};
+
+static const int CUTOFF_PARAM_MAX = 1000;
+static const int MIDI_NOTES = 128;
+
+// 20 * 1000^(param/1000)
+constexpr float cutoff_table_entry(int param)
+{
+    return (float)(20.0 * const_exp(6.90775527898213705205 * param / CUTOFF_PARAM_MAX));
+}
+
+// 440 * 2^((note-69)/12)
+constexpr float note_table_entry(int note)
+{
+    return (float)(440.0 * const_exp(0.69314718055994530942 * (note - 69) / 12.0));
+}
+
+template <int... I>
+constexpr FloatTable<sizeof...(I)> make_cutoff_table(IndexSeq<I...>)
+{
+    return FloatTable<sizeof...(I)>{ { cutoff_table_entry(I)... } };
+}
+
+template <int... I>
+constexpr FloatTable<sizeof...(I)> make_note_table(IndexSeq<I...>)
+{
+    return FloatTable<sizeof...(I)>{ { note_table_entry(I)... } };
+}
+
+static constexpr FloatTable<CUTOFF_PARAM_MAX + 1> CUTOFF_TABLE =
+    make_cutoff_table(MakeSeq<CUTOFF_PARAM_MAX + 1>::type());
+static constexpr FloatTable<MIDI_NOTES> NOTE_TABLE =
+    make_note_table(MakeSeq<MIDI_NOTES>::type());
+
 // Cutoff parameter (0-1000) to Hz (20-20000, exponential)
 // freq = 20 * 1000^(param/1000)
 inline float cutoff_param_to_hz(int param)
 {
-    return 20.0f * powf(1000.0f, (float)param / 1000.0f);
+    if (param < 0) param = 0;
+    if (param > CUTOFF_PARAM_MAX) param = CUTOFF_PARAM_MAX;
+    return CUTOFF_TABLE.v[param];
+}
+
+// MIDI note (0-127) to Hz by table lookup
+inline float midi_note_to_freq_table(int note)
+{
+    if (note < 0) note = 0;
+    if (note > MIDI_NOTES - 1) note = MIDI_NOTES - 1;
+    return NOTE_TABLE.v[note];
+}
+
+// Keyboard tracking: cutoff multiplier for a note relative to C4 (note 60).
+// amount scales the tracking (1 = one octave per octave); fractional notes
+// interpolate linearly between table entries (error < 0.05%).
+inline float keytrack_mult(int note, float amount)
+{
+    float n = 60.0f + (float)(note - 60) * amount;
+    if (n < 0.0f) n = 0.0f;
+    if (n > (float)(MIDI_NOTES - 1)) n = (float)(MIDI_NOTES - 1);
+    int i = (int)n;
+    if (i > MIDI_NOTES - 2) i = MIDI_NOTES - 2;
+    float frac = n - (float)i;
+    float hz = NOTE_TABLE.v[i] + (NOTE_TABLE.v[i + 1] - NOTE_TABLE.v[i]) * frac;
+    return hz * (1.0f / 261.6255653f);
 }
 
 // Resonance parameter (0-1000) to damping factor
 // 0 = Butterworth (damping=0.707), 1000 = near self-oscillation (damping=0.01)
-inline float resonance_to_damping(int param)
+// (Linear, so a multiply-add beats a table read; constexpr for compile-time use.)
+constexpr float resonance_to_damping(int param)
 {
-    float t = (float)param / 1000.0f;
-    return 0.707f * (1.0f - t) + 0.01f * t;
+    return 0.707f * (1.0f - (float)param / 1000.0f) + 0.01f * ((float)param / 1000.0f);
 }
 
 // ============================================================
@@ -73,12 +210,19 @@ inline float resonance_to_damping(int param)
 // Reference: https://github.com/yIvantsov/ivantsov-filters
 // ============================================================
 
-struct Filter1
+struct Filter1Coeffs
 {
-    float z;        // state variable
     float b0, b1;   // coefficients
+    float b2;       // z term of a shelf's output
+
+    Filter1Coeffs() : b0(0.0f), b1(0.0f), b2(0.0f) {}
+};
 
-    Filter1() : z(0.0f), b0(0.0f), b1(0.0f) {}
+struct Filter1 : Filter1Coeffs
+{
+    float z;        // state variable
+
+    Filter1() : z(0.0f) {}
 
     void reset() { z = 0.0f; }
 
@@ -99,11 +243,72 @@ struct Filter1
         z += theta;
         return y;
     }
+
+    // Shelf output: x + theta*b1 + z*b2
+    float process_shelf(float x)
+    {
+        float theta = (x - z) * b0;
+        float y = x + theta * b1 + z * b2;
+        z += theta;
+        return y;
+    }
+
+    // Block variants keep state and coefficients in locals for the whole
+    // block instead of going through the struct every sample. in and out may
+    // be the same buffer.
+    void process_lp_block(const float* in, float* out, int n)
+    {
+        float s = z, c0 = b0, c1 = b1;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s) * c0;
+            out[i] = theta * c1 + s;
+            s += theta;
+        }
+        z = s;
+    }
+
+    void process_hp_block(const float* in, float* out, int n)
+    {
+        float s = z, c0 = b0, c1 = b1;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s) * c0;
+            out[i] = theta * c1;
+            s += theta;
+        }
+        z = s;
+    }
+
+    // Per-sample coefficients: sample i uses c[i]
+    void process_lp_block(const float* in, float* out, int n, const Filter1Coeffs* c)
+    {
+        float s = z;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s) * c[i].b0;
+            out[i] = theta * c[i].b1 + s;
+            s += theta;
+        }
+        z = s;
+    }
+
+    void process_hp_block(const float* in, float* out, int n, const Filter1Coeffs* c)
+    {
+        float s = z;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s) * c[i].b0;
+            out[i] = theta * c[i].b1;
+            s += theta;
+        }
+        z = s;
+    }
 };
 
 // Configure first-order low-pass coefficients
 // Uses Sigma frequency warping for audio-rate modulation quality
-inline void filter1_configure_lp(Filter1& f, float sample_rate, float cutoff_hz)
+inline void filter1_configure_lp(Filter1Coeffs& f, float sample_rate, float cutoff_hz)
 {
     float w = sample_rate / (2.0f * PI * cutoff_hz);
     float sigma = INV_PI;
@@ -115,7 +320,7 @@ inline void filter1_configure_lp(Filter1& f, float sample_rate, float cutoff_hz)
 }
 
 // Configure first-order high-pass coefficients
-inline void filter1_configure_hp(Filter1& f, float sample_rate, float cutoff_hz)
+inline void filter1_configure_hp(Filter1Coeffs& f, float sample_rate, float cutoff_hz)
 {
     float w = sample_rate / (2.0f * PI * cutoff_hz);
     float sigma = INV_PI;
@@ -126,6 +331,30 @@ inline void filter1_configure_hp(Filter1& f, float sample_rate, float cutoff_hz)
     f.b1 = w;
 }
 
+// First-order shelves, by the bilinear transform: x + (gain - 1) * LP (low
+// shelf) or x + (gain - 1) * HP (high shelf), output x + theta*b1 + z*b2.
+// gain is linear (DC gain of a low shelf, top gain of a high shelf); the
+// pole is placed so freq_hz is where the response is halfway in dB.
+inline void filter1_configure_low_shelf(Filter1Coeffs& f, float sample_rate,
+                                        float freq_hz, float gain)
+{
+    if (freq_hz > 0.45f * sample_rate) freq_hz = 0.45f * sample_rate;
+    float k = sqrtf(gain) / tanf(PI * freq_hz / sample_rate);
+    f.b0 = 2.0f / (k + 1.0f);
+    f.b1 = 0.5f * (gain - 1.0f);
+    f.b2 = gain - 1.0f;
+}
+
+inline void filter1_configure_high_shelf(Filter1Coeffs& f, float sample_rate,
+                                         float freq_hz, float gain)
+{
+    if (freq_hz > 0.45f * sample_rate) freq_hz = 0.45f * sample_rate;
+    float k = 1.0f / (sqrtf(gain) * tanf(PI * freq_hz / sample_rate));
+    f.b0 = 2.0f / (k + 1.0f);
+    f.b1 = 0.5f * (gain - 1.0f) * k;
+    f.b2 = 0.0f;
+}
+
 // ============================================================
 // Second-order state-space filter (12 dB/oct)
 // Ported from ivantsov-filters by Yuriy Ivantsov (C++20 -> C++11)
@@ -138,15 +367,32 @@ enum Filter2Type
     F2_HP,       // High-pass
     F2_BP,       // Band-pass
     F2_NOTCH,    // Notch (band reject)
-    F2_AP        // All-pass
+    F2_AP,       // All-pass
+    F2_LOW_SHELF,   // Low shelf (see filter2_configure_eq)
+    F2_HIGH_SHELF,  // High shelf
+    F2_PEAK         // Peaking (bell)
 };
 
-struct Filter2
+// Shelf and peak types mix the input back in, and their output has a z0
+// term of its own (b4; see process_eq)
+inline bool filter2_type_is_eq(Filter2Type type)
+{
+    return type >= F2_LOW_SHELF;
+}
+
+struct Filter2Coeffs
 {
-    float z0, z1;           // state variables
     float b0, b1, b2, b3;   // coefficients
+    float b4;               // z0 term of a shelf/peak output
+
+    Filter2Coeffs() : b0(0.0f), b1(0.0f), b2(0.0f), b3(0.0f), b4(0.0f) {}
+};
+
+struct Filter2 : Filter2Coeffs
+{
+    float z0, z1;           // state variables
 
-    Filter2() : z0(0.0f), z1(0.0f), b0(0.0f), b1(0.0f), b2(0.0f), b3(0.0f) {}
+    Filter2() : z0(0.0f), z1(0.0f) {}
 
     void reset() { z0 = z1 = 0.0f; }
 
@@ -169,63 +415,1638 @@ struct Filter2
         z1 = -z1 - theta * b1;
         return y;
     }
+
+    // Process for shelf and peak types (output adds x and z0 * b4)
+    float process_eq(float x)
+    {
+        float theta = (x - z0 - z1 * b1) * b0;
+        float y = x + theta * b3 + z1 * b2 + z0 * b4;
+        z0 += theta;
+        z1 = -z1 - theta * b1;
+        return y;
+    }
+
+    // Block variants (see Filter1)
+    void process_lna_block(const float* in, float* out, int n)
+    {
+        float s0 = z0, s1 = z1;
+        float c0 = b0, c1 = b1, c2 = b2, c3 = b3;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c1) * c0;
+            out[i] = theta * c3 + s1 * c2 + s0;
+            s0 += theta;
+            s1 = -s1 - theta * c1;
+        }
+        z0 = s0; z1 = s1;
+    }
+
+    void process_hb_block(const float* in, float* out, int n)
+    {
+        float s0 = z0, s1 = z1;
+        float c0 = b0, c1 = b1, c2 = b2, c3 = b3;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c1) * c0;
+            out[i] = theta * c3 + s1 * c2;
+            s0 += theta;
+            s1 = -s1 - theta * c1;
+        }
+        z0 = s0; z1 = s1;
+    }
+
+    void process_eq_block(const float* in, float* out, int n)
+    {
+        float s0 = z0, s1 = z1;
+        float c0 = b0, c1 = b1, c2 = b2, c3 = b3, c4 = b4;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c1) * c0;
+            out[i] = in[i] + theta * c3 + s1 * c2 + s0 * c4;
+            s0 += theta;
+            s1 = -s1 - theta * c1;
+        }
+        z0 = s0; z1 = s1;
+    }
+
+    // Per-sample coefficients: sample i uses c[i]
+    void process_lna_block(const float* in, float* out, int n, const Filter2Coeffs* c)
+    {
+        float s0 = z0, s1 = z1;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c[i].b1) * c[i].b0;
+            out[i] = theta * c[i].b3 + s1 * c[i].b2 + s0;
+            s0 += theta;
+            s1 = -s1 - theta * c[i].b1;
+        }
+        z0 = s0; z1 = s1;
+    }
+
+    void process_hb_block(const float* in, float* out, int n, const Filter2Coeffs* c)
+    {
+        float s0 = z0, s1 = z1;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c[i].b1) * c[i].b0;
+            out[i] = theta * c[i].b3 + s1 * c[i].b2;
+            s0 += theta;
+            s1 = -s1 - theta * c[i].b1;
+        }
+        z0 = s0; z1 = s1;
+    }
+
+    void process_eq_block(const float* in, float* out, int n, const Filter2Coeffs* c)
+    {
+        float s0 = z0, s1 = z1;
+        for (int i = 0; i < n; i++)
+        {
+            float theta = (in[i] - s0 - s1 * c[i].b1) * c[i].b0;
+            out[i] = in[i] + theta * c[i].b3 + s1 * c[i].b2 + s0 * c[i].b4;
+            s0 += theta;
+            s1 = -s1 - theta * c[i].b1;
+        }
+        z0 = s0; z1 = s1;
+    }
 };
 
-// Configure second-order filter coefficients
-// Uses Sigma frequency warping for audio-rate modulation quality
-// damping = 1/(2*Q), e.g. 0.707 = Butterworth, lower = more resonant
-inline void filter2_configure(Filter2& f, float sample_rate, float cutoff_hz,
-                               float damping, Filter2Type type)
+// Intermediate terms of a second-order configuration, grouped by what they
+// depend on. Keeping them lets a configuration be updated incrementally
+// (filter2_configure_cached): a damping-only change skips the sigma warp,
+// and a type-only change just redoes b2/b3.
+struct Filter2Terms
+{
+    // Inputs the terms were computed for
+    float sample_rate, cutoff_hz, damping;
+    int type;
+
+    float w, sigma, w_sq, sigma_sq;   // cutoff terms
+    float zeta_term;                  // damping term: 2*damping^2 - 1
+    float v, root;                    // state terms: v and sqrtf(v + k)
+
+    // Inputs start out invalid, so the first configure computes everything
+    Filter2Terms() : sample_rate(0.0f), cutoff_hz(0.0f), damping(-1.0f), type(-1),
+                     w(0.0f), sigma(0.0f), w_sq(0.0f), sigma_sq(0.0f),
+                     zeta_term(0.0f), v(0.0f), root(0.0f) {}
+};
+
+// Cutoff terms: normalized frequency and its sigma warp
+inline void filter2_cutoff_terms(Filter2Terms& t, float sample_rate, float cutoff_hz)
 {
     float w = sample_rate / (SQRT2 * PI * cutoff_hz);
     float sigma = SQRT2 * INV_PI;
     if (w > INV_PI * SQRT2)
         sigma = 0.57735268f * (0.11686715f - w * w) / (0.09186588f - w * w);
+    t.w = w;
+    t.sigma = sigma;
+    t.w_sq = w * w;
+    t.sigma_sq = sigma * sigma;
+    t.sample_rate = sample_rate;
+    t.cutoff_hz = cutoff_hz;
+}
 
-    float w_sq = w * w;
-    float sigma_sq = sigma * sigma;
+inline void filter2_damping_terms(Filter2Terms& t, float damping)
+{
     float zeta_sq = damping * damping;
+    t.zeta_term = 2.0f * zeta_sq - 1.0f;
+    t.damping = damping;
+}
 
-    // vk computation (state-space eigenvalue decomposition)
-    float t = w_sq * (2.0f * zeta_sq - 1.0f);
-    float v = sqrtf(w_sq * w_sq + sigma_sq * (2.0f * t + sigma_sq));
-    float k = t + sigma_sq;
-
-    f.b0 = 1.0f / (v + sqrtf(v + k) + 0.5f);
+// b0/b1 from the cutoff and damping terms (state-space eigenvalue
+// decomposition)
+inline void filter2_state_terms(Filter2Coeffs& f, Filter2Terms& t)
+{
+    float tt = t.w_sq * t.zeta_term;
+    float v = sqrtf(t.w_sq * t.w_sq + t.sigma_sq * (2.0f * tt + t.sigma_sq));
+    float k = tt + t.sigma_sq;
+    float root = sqrtf(v + k);
+    t.v = v;
+    t.root = root;
+    f.b0 = 1.0f / (v + root + 0.5f);
     f.b1 = sqrtf(2.0f * v);
+}
 
+// Type-specific output coefficients b2/b3
+inline void filter2_output_terms(Filter2Coeffs& f, Filter2Terms& t, Filter2Type type)
+{
     switch (type)
     {
     case F2_LP:
-        f.b2 = 2.0f * sigma_sq / f.b1;
-        f.b3 = 0.5f + sigma_sq + SQRT2 * sigma;
+        f.b2 = 2.0f * t.sigma_sq / f.b1;
+        f.b3 = 0.5f + t.sigma_sq + SQRT2 * t.sigma;
         break;
     case F2_HP:
-        f.b2 = 2.0f * w_sq / f.b1;
-        f.b3 = w_sq;
+        f.b2 = 2.0f * t.w_sq / f.b1;
+        f.b3 = t.w_sq;
         break;
     case F2_BP:
-        f.b2 = 4.0f * w * damping * sigma / f.b1;
-        f.b3 = 2.0f * w * damping * (sigma + INV_SQRT2);
+        f.b2 = 4.0f * t.w * t.damping * t.sigma / f.b1;
+        f.b3 = 2.0f * t.w * t.damping * (t.sigma + INV_SQRT2);
         break;
     case F2_NOTCH:
-        f.b2 = 2.0f * (w_sq - sigma_sq) / f.b1;
-        f.b3 = 0.5f + w_sq - sigma_sq;
+        f.b2 = 2.0f * (t.w_sq - t.sigma_sq) / f.b1;
+        f.b3 = 0.5f + t.w_sq - t.sigma_sq;
         break;
     case F2_AP:
         f.b2 = f.b1;
-        f.b3 = 0.5f + v - sqrtf(v + k);
+        f.b3 = 0.5f + t.v - t.root;
+        break;
+    default:    // shelf/peak types: see filter2_configure_eq
         break;
     }
+    t.type = type;
+}
+
+// Configure second-order filter coefficients
+// Uses Sigma frequency warping for audio-rate modulation quality
+// damping = 1/(2*Q), e.g. 0.707 = Butterworth, lower = more resonant
+// (Shelf and peak types also need a gain: see filter2_configure_eq.)
+inline void filter2_configure(Filter2Coeffs& f, float sample_rate, float cutoff_hz,
+                               float damping, Filter2Type type)
+{
+    Filter2Terms t;
+    filter2_cutoff_terms(t, sample_rate, cutoff_hz);
+    filter2_damping_terms(t, damping);
+    filter2_state_terms(f, t);
+    filter2_output_terms(f, t, type);
+}
+
+// Configure a shelf or peak type: the RBJ cookbook sections, by the
+// bilinear transform, mapped onto the state-space form. With
+// k = 1/tan(pi*fc/fs), b1 = k and b0 = 2/(k^2 + 2*damping*k + 1) give the
+// transform's poles (the sigma-warped types tend to these as sigma -> 0),
+// and an analog numerator D(s) + n2*s^2 + n1*s + n0 (D the denominator)
+// becomes the output x + theta*b3 + z1*b2 + z0*b4 with
+// b3 = (n2*k^2 + n1*k + n0)/2, b2 = n2*k, b4 = n0.
+//
+// gain is linear: the DC gain of a low shelf, the top gain of a high
+// shelf, the centre gain of a peak. freq_hz is a shelf's halfway point in
+// dB or a peak's centre. damping sets the shelf slope (0.707 = no
+// overshoot) or the peak width; with a = sqrt(gain) the peak's poles
+// narrow to damping / a, so boosts and cuts of the same size mirror each
+// other.
+inline void filter2_configure_eq(Filter2Coeffs& f, float sample_rate, float freq_hz,
+                                 float damping, float gain, Filter2Type type)
+{
+    if (freq_hz > 0.45f * sample_rate) freq_hz = 0.45f * sample_rate;
+    float a = sqrtf(gain);
+    float k = 1.0f / tanf(PI * freq_hz / sample_rate);
+    float n2 = 0.0f, n1, n0 = 0.0f;
+    if (type == F2_LOW_SHELF)
+    {
+        k *= sqrtf(a);          // poles at freq_hz / sqrt(a)
+        n1 = 2.0f * damping * (a - 1.0f);
+        n0 = gain - 1.0f;
+    }
+    else if (type == F2_HIGH_SHELF)
+    {
+        k /= sqrtf(a);          // poles at freq_hz * sqrt(a)
+        n2 = gain - 1.0f;
+        n1 = 2.0f * damping * (a - 1.0f);
+    }
+    else
+    {
+        damping /= a;
+        n1 = 2.0f * damping * (gain - 1.0f);
+    }
+    f.b0 = 2.0f / (k * k + 2.0f * damping * k + 1.0f);
+    f.b1 = k;
+    f.b2 = n2 * k;
+    f.b3 = 0.5f * ((n2 * k + n1) * k + n0);
+    f.b4 = n0;
+}
+
+// Same result as filter2_configure, recomputing only the terms whose inputs
+// changed since the last call with t. t must only ever be used with f.
+// Returns false when nothing changed.
+inline bool filter2_configure_cached(Filter2Coeffs& f, Filter2Terms& t,
+                                     float sample_rate, float cutoff_hz,
+                                     float damping, Filter2Type type)
+{
+    bool cutoff_moved = cutoff_hz != t.cutoff_hz || sample_rate != t.sample_rate;
+    bool damping_moved = damping != t.damping;
+    if (cutoff_moved)
+        filter2_cutoff_terms(t, sample_rate, cutoff_hz);
+    if (damping_moved)
+        filter2_damping_terms(t, damping);
+    if (cutoff_moved || damping_moved)
+        filter2_state_terms(f, t);
+    else if (type == t.type)
+        return false;
+    filter2_output_terms(f, t, type);
+    return true;
 }
 
 // Process one sample through a second-order filter
 inline float filter2_process(Filter2& f, float x, Filter2Type type)
 {
+    if (filter2_type_is_eq(type))
+        return f.process_eq(x);
     if (type == F2_HP || type == F2_BP)
         return f.process_hb(x);
     else
         return f.process_lna(x);
 }
 
+// Process a block through a second-order filter
+inline void filter2_process_block(Filter2& f, const float* in, float* out,
+                                  int n, Filter2Type type)
+{
+    if (filter2_type_is_eq(type))
+        f.process_eq_block(in, out, n);
+    else if (type == F2_HP || type == F2_BP)
+        f.process_hb_block(in, out, n);
+    else
+        f.process_lna_block(in, out, n);
+}
+
+inline void filter2_process_block(Filter2& f, const float* in, float* out,
+                                  int n, const Filter2Coeffs* c, Filter2Type type)
+{
+    if (filter2_type_is_eq(type))
+        f.process_eq_block(in, out, n, c);
+    else if (type == F2_HP || type == F2_BP)
+        f.process_hb_block(in, out, n, c);
+    else
+        f.process_lna_block(in, out, n, c);
+}
+
+// Copy coefficients (not state) between filters, e.g. to the second stage
+// of a cascade, which always runs the same coefficients as the first
+inline void filter2_copy_coefficients(Filter2& dst, const Filter2& src)
+{
+    static_cast<Filter2Coeffs&>(dst) = src;
+}
+
+// Two stages in series
+inline float filter2_cascade(Filter2& a, Filter2& b, float x, Filter2Type type)
+{
+    return filter2_process(b, filter2_process(a, x, type), type);
+}
+
+// Block cascade: stage A over the block, then stage B over A's output
+inline void filter2_cascade_block(Filter2& a, Filter2& b, const float* in,
+                                  float* out, int n, Filter2Type type)
+{
+    filter2_process_block(a, in, out, n, type);
+    filter2_process_block(b, out, out, n, type);
+}
+
+// ============================================================
+// Four-pole ladder filter (24 dB/oct, Moog-style)
+// Zero-delay-feedback solve with per-stage tanh saturation and saturated
+// resonance feedback. Each tanh is linearized around the previous sample's
+// state (one-step prediction, no iteration), so the solve is a fixed
+// sequence of operations and every sample costs the same.
+// ============================================================
+
+// tanh(x)/x, using the soft_clip rational for |x| < 3 and 1/|x| beyond,
+// where soft_clip reaches +/-1
+inline float tanh_ratio(float x)
+{
+    float x2 = x * x;
+    if (x2 >= 9.0f)
+        return 1.0f / fabsf(x);
+    return (27.0f + x2) / (27.0f + 9.0f * x2);
+}
+
+struct Ladder
+{
+    float s[4];     // trapezoidal integrator states, one per stage
+    float g;        // prewarped integrator gain tan(pi*fc/fs)
+    float k;        // resonance feedback, self-oscillation at 4
+
+    Ladder() : g(0.0f), k(0.0f) { reset(); }
+
+    void reset() { s[0] = s[1] = s[2] = s[3] = 0.0f; }
+
+    float process(float x)
+    {
+        // Each stage solves y = s + g*(tanh(u) - tanh(y)) with
+        // tanh(u) ~ u*tanh_ratio(u_est) and tanh(y) ~ y*tanh_ratio(s), which
+        // gives y = G*u + S. Stage inputs are estimated by the previous
+        // stage's state, so stage i's input ratio is stage i-1's ratio.
+        float t_in = tanh_ratio(x - k * s[3]);
+        float t0 = tanh_ratio(s[0]);
+        float t1 = tanh_ratio(s[1]);
+        float t2 = tanh_ratio(s[2]);
+        float t3 = tanh_ratio(s[3]);
+
+        float d0 = 1.0f / (1.0f + g * t0);
+        float d1 = 1.0f / (1.0f + g * t1);
+        float d2 = 1.0f / (1.0f + g * t2);
+        float d3 = 1.0f / (1.0f + g * t3);
+        float G0 = g * t_in * d0, S0 = s[0] * d0;
+        float G1 = g * t0 * d1,   S1 = s[1] * d1;
+        float G2 = g * t1 * d2,   S2 = s[2] * d2;
+        float G3 = g * t2 * d3,   S3 = s[3] * d3;
+
+        // Resolve the zero-delay feedback loop: y3 = Gt*(x - k*y3) + St
+        float Gt = G0 * G1 * G2 * G3;
+        float St = G3 * (G2 * (G1 * S0 + S1) + S2) + S3;
+        float y3 = (Gt * x + St) / (1.0f + k * Gt);
+
+        float y0 = G0 * (x - k * y3) + S0;
+        float y1 = G1 * y0 + S1;
+        float y2 = G2 * y1 + S2;
+        s[0] = 2.0f * y0 - s[0];
+        s[1] = 2.0f * y1 - s[1];
+        s[2] = 2.0f * y2 - s[2];
+        s[3] = 2.0f * y3 - s[3];
+        return y3;
+    }
+};
+
+// Configure the ladder from the same damping range as Filter2
+// (0.707 = no resonance, 0.01 = self-oscillation)
+inline void ladder_configure(Ladder& f, float sample_rate, float cutoff_hz,
+                             float damping)
+{
+    if (cutoff_hz > 0.49f * sample_rate)
+        cutoff_hz = 0.49f * sample_rate;
+    f.g = tanf(PI * cutoff_hz / sample_rate);
+    f.k = 4.0f * (0.707f - damping) / (0.707f - 0.01f);
+}
+
+// ============================================================
+// Band-pass bank (formants / resonators)
+// ============================================================
+
+static const int BANK_MAX_BANDS = 8;
+
+// A bank of up to this many bands runs only that many lanes, a larger one
+// runs all BANK_MAX_BANDS; both loops keep a fixed trip count the compiler
+// can vectorize
+static const int BANK_GROUP = 4;
+
+// Where a bank's bands sit relative to the cutoff: band i is centred at
+// cutoff * ratio[i], with damping width[i] at 0% resonance (narrowing with
+// the Resonance control) and output gain gain[i]. Bands past num are silent.
+struct BankLayout
+{
+    int num;
+    float ratio[BANK_MAX_BANDS];
+    float width[BANK_MAX_BANDS];
+    float gain[BANK_MAX_BANDS];
+
+    BankLayout() : num(0)
+    {
+        for (int i = 0; i < BANK_MAX_BANDS; i++)
+        {
+            ratio[i] = 1.0f;
+            width[i] = 0.707f;
+            gain[i] = 0.0f;
+        }
+    }
+};
+
+// Parallel F2_BP filters, stored as struct-of-arrays so the per-band
+// recursions are independent lanes (vectorized on host, interleaved in the
+// M7 pipeline). Gains are folded into each band's output coefficients.
+// Bands past num have zero coefficients and, below BANK_GROUP bands, don't
+// run at all, so fewer bands cost less.
+struct BandpassBank
+{
+    int num;    // bands configured
+    int lanes;  // bands run: BANK_GROUP or BANK_MAX_BANDS
+    float z0[BANK_MAX_BANDS], z1[BANK_MAX_BANDS];
+    float b0[BANK_MAX_BANDS], b1[BANK_MAX_BANDS];
+    float b2[BANK_MAX_BANDS], b3[BANK_MAX_BANDS];
+
+    // Targets the coefficients were last computed for
+    float freq[BANK_MAX_BANDS], damp[BANK_MAX_BANDS], gain[BANK_MAX_BANDS];
+
+    BandpassBank() : num(0), lanes(0)
+    {
+        for (int i = 0; i < BANK_MAX_BANDS; i++)
+        {
+            z0[i] = z1[i] = 0.0f;
+            b0[i] = b1[i] = b2[i] = b3[i] = 0.0f;
+            freq[i] = damp[i] = gain[i] = 0.0f;
+        }
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < BANK_MAX_BANDS; i++)
+            z0[i] = z1[i] = 0.0f;
+    }
+
+    template <int N>
+    void flush_lanes()
+    {
+        for (int i = 0; i < N; i++)
+        {
+            z0[i] = flush_denormal(z0[i]);
+            z1[i] = flush_denormal(z1[i]);
+        }
+    }
+
+    void flush_denormals()
+    {
+        if (lanes > BANK_GROUP)
+            flush_lanes<BANK_MAX_BANDS>();
+        else
+            flush_lanes<BANK_GROUP>();
+    }
+
+    // The first N bands, with a trip count fixed at compile time
+    template <int N>
+    float process_lanes(float x)
+    {
+        float y = 0.0f;
+        for (int i = 0; i < N; i++)
+        {
+            float theta = (x - z0[i] - z1[i] * b1[i]) * b0[i];
+            y += theta * b3[i] + z1[i] * b2[i];
+            z0[i] += theta;
+            z1[i] = -z1[i] - theta * b1[i];
+        }
+        return y;
+    }
+
+    float process(float x)
+    {
+        return lanes > BANK_GROUP ? process_lanes<BANK_MAX_BANDS>(x)
+                                  : process_lanes<BANK_GROUP>(x);
+    }
+
+    void process_block(const float* in, float* out, int n)
+    {
+        for (int j = 0; j < n; j++)
+            out[j] = process(in[j]);
+    }
+};
+
+// Set each band from a layout. Only bands whose centre, damping or gain
+// moved are recomputed. Bands above 0.45 * sample_rate are muted. Bands
+// dropped from the layout are cleared once and then skipped.
+inline void bandpass_bank_configure(BandpassBank& bank, float sample_rate,
+                                    float cutoff_hz, float damping,
+                                    const BankLayout& layout)
+{
+    for (int i = layout.num; i < bank.num; i++)
+    {
+        bank.z0[i] = bank.z1[i] = 0.0f;
+        bank.b0[i] = bank.b1[i] = bank.b2[i] = bank.b3[i] = 0.0f;
+        bank.freq[i] = bank.damp[i] = bank.gain[i] = 0.0f;
+    }
+    bank.num = layout.num;
+    bank.lanes = layout.num > BANK_GROUP ? BANK_MAX_BANDS : BANK_GROUP;
+
+    float top = 0.45f * sample_rate;
+    float res = damping * (1.0f / 0.707f);
+    for (int i = 0; i < layout.num; i++)
+    {
+        float f = cutoff_hz * layout.ratio[i];
+        float d = layout.width[i] * res;
+        float g = layout.gain[i];
+        if (f > top)
+        {
+            f = top;
+            g = 0.0f;
+        }
+        if (d < 0.005f) d = 0.005f;
+        if (f == bank.freq[i] && d == bank.damp[i] && g == bank.gain[i])
+            continue;
+        bank.freq[i] = f;
+        bank.damp[i] = d;
+        bank.gain[i] = g;
+
+        Filter2Coeffs c;
+        filter2_configure(c, sample_rate, f, d, F2_BP);
+        bank.b0[i] = c.b0;
+        bank.b1[i] = c.b1;
+        bank.b2[i] = c.b2 * g;
+        bank.b3[i] = c.b3 * g;
+    }
+}
+
+// Formant centres for the vowels A E I O U (bass voice), in Hz, with
+// relative levels in dB and bandwidths in Hz
+static const int NUM_VOWELS = 5;
+static const int NUM_FORMANTS = 5;
+
+static const float FORMANT_FREQ[NUM_VOWELS][NUM_FORMANTS] = {
+    { 600.0f, 1040.0f, 2250.0f, 2450.0f, 2750.0f },   // A
+    { 400.0f, 1620.0f, 2400.0f, 2800.0f, 3100.0f },   // E
+    { 250.0f, 1750.0f, 2600.0f, 3050.0f, 3340.0f },   // I
+    { 400.0f,  750.0f, 2400.0f, 2600.0f, 2900.0f },   // O
+    { 350.0f,  600.0f, 2400.0f, 2675.0f, 2950.0f },   // U
+};
+static const float FORMANT_DB[NUM_VOWELS][NUM_FORMANTS] = {
+    { 0.0f,  -7.0f,  -9.0f,  -9.0f, -20.0f },
+    { 0.0f, -12.0f,  -9.0f, -12.0f, -18.0f },
+    { 0.0f, -30.0f, -16.0f, -22.0f, -28.0f },
+    { 0.0f, -11.0f, -21.0f, -20.0f, -40.0f },
+    { 0.0f, -20.0f, -32.0f, -28.0f, -36.0f },
+};
+static const float FORMANT_BW[NUM_VOWELS][NUM_FORMANTS] = {
+    { 60.0f, 70.0f, 110.0f, 120.0f, 130.0f },
+    { 40.0f, 80.0f, 100.0f, 120.0f, 120.0f },
+    { 60.0f, 90.0f, 100.0f, 120.0f, 120.0f },
+    { 40.0f, 80.0f, 100.0f, 120.0f, 120.0f },
+    { 40.0f, 80.0f, 100.0f, 120.0f, 120.0f },
+};
+
+// Cutoff at which the formants sit at their table frequencies (cutoff
+// parameter 500); moving the cutoff shifts all formants together
+static const float FORMANT_REF_HZ = 632.455532f;
+
+// Formant layout for a vowel position 0-4 (A E I O U), interpolating
+// between neighbouring vowels. bands limits the number of formants used.
+inline void formant_layout(BankLayout& layout, float vowel, int bands)
+{
+    if (!(vowel > 0.0f)) vowel = 0.0f;   // (NaN too)
+    if (vowel > (float)(NUM_VOWELS - 1)) vowel = (float)(NUM_VOWELS - 1);
+    int v = (int)vowel;
+    if (v > NUM_VOWELS - 2) v = NUM_VOWELS - 2;
+    float t = vowel - (float)v;
+
+    layout = BankLayout();
+    layout.num = bands < NUM_FORMANTS ? bands : NUM_FORMANTS;
+    for (int i = 0; i < layout.num; i++)
+    {
+        float f = FORMANT_FREQ[v][i] + (FORMANT_FREQ[v + 1][i] - FORMANT_FREQ[v][i]) * t;
+        float db = FORMANT_DB[v][i] + (FORMANT_DB[v + 1][i] - FORMANT_DB[v][i]) * t;
+        float bw = FORMANT_BW[v][i] + (FORMANT_BW[v + 1][i] - FORMANT_BW[v][i]) * t;
+        layout.ratio[i] = f * (1.0f / FORMANT_REF_HZ);
+        layout.width[i] = 0.5f * bw / f;   // damping = 1/(2Q), Q = f/bw
+        layout.gain[i] = powf(10.0f, db * 0.05f);
+    }
+}
+
+// Harmonic resonator layout: bands at 1, 2, 3... times the cutoff with
+// 1/n gains, so V/OCT on the cutoff tracks the whole series
+inline void harmonic_layout(BankLayout& layout, int bands)
+{
+    if (bands > BANK_MAX_BANDS) bands = BANK_MAX_BANDS;
+    layout = BankLayout();
+    layout.num = bands;
+    for (int i = 0; i < bands; i++)
+    {
+        layout.ratio[i] = (float)(i + 1);
+        layout.width[i] = 0.1f;
+        layout.gain[i] = 1.0f / (float)(i + 1);
+    }
+}
+
+// ============================================================
+// Multi-band EQ
+// ============================================================
+
+static const int EQ_MAX_BANDS = 4;
+
+// EQ bands: band i is a section of type type[i] at freq[i] Hz with linear
+// gain gain[i] and damping width[i] at 0% resonance (narrowing with the
+// Resonance control, like BankLayout). Bands past num don't run. The
+// sections are in series, so their order doesn't change the response.
+struct EQLayout
+{
+    int num;
+    Filter2Type type[EQ_MAX_BANDS];
+    float freq[EQ_MAX_BANDS];
+    float gain[EQ_MAX_BANDS];
+    float width[EQ_MAX_BANDS];
+
+    EQLayout() : num(0)
+    {
+        for (int i = 0; i < EQ_MAX_BANDS; i++)
+        {
+            type[i] = F2_PEAK;
+            freq[i] = 1000.0f;
+            gain[i] = 1.0f;
+            width[i] = 0.707f;
+        }
+    }
+};
+
+// Standard 3 or 4 band layout: low shelf, high shelf, then one or two peaks
+// (0.5 damping, Q = 1). Frequencies in Hz and gains in dB, in the order
+// low, high, mid, mid 2.
+inline void eq_layout(EQLayout& layout, int bands, const float* freq,
+                      const float* gain_db)
+{
+    layout = EQLayout();
+    layout.num = bands < 3 ? 3 : (bands > EQ_MAX_BANDS ? EQ_MAX_BANDS : bands);
+    for (int i = 0; i < EQ_MAX_BANDS; i++)
+    {
+        layout.type[i] = i == 0 ? F2_LOW_SHELF : (i == 1 ? F2_HIGH_SHELF : F2_PEAK);
+        layout.freq[i] = freq[i];
+        layout.gain[i] = powf(10.0f, gain_db[i] * 0.05f);
+        layout.width[i] = i < 2 ? 0.707f : 0.5f;
+    }
+}
+
+// Series shelf/peak sections in one filter, stored as struct-of-arrays.
+// Coefficients are only recomputed when a band's settings change, so a
+// static EQ costs its sections' recursions and nothing else.
+struct EQBank
+{
+    int num;
+    float z0[EQ_MAX_BANDS], z1[EQ_MAX_BANDS];
+    float b0[EQ_MAX_BANDS], b1[EQ_MAX_BANDS], b2[EQ_MAX_BANDS];
+    float b3[EQ_MAX_BANDS], b4[EQ_MAX_BANDS];
+
+    // Targets the coefficients were last computed for
+    int type[EQ_MAX_BANDS];
+    float freq[EQ_MAX_BANDS], damp[EQ_MAX_BANDS], gain[EQ_MAX_BANDS];
+
+    EQBank() : num(0)
+    {
+        for (int i = 0; i < EQ_MAX_BANDS; i++)
+        {
+            z0[i] = z1[i] = 0.0f;
+            b0[i] = b1[i] = b2[i] = b3[i] = b4[i] = 0.0f;
+            type[i] = -1;
+            freq[i] = damp[i] = gain[i] = 0.0f;
+        }
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < EQ_MAX_BANDS; i++)
+            z0[i] = z1[i] = 0.0f;
+    }
+
+    void flush_denormals()
+    {
+        for (int i = 0; i < EQ_MAX_BANDS; i++)
+        {
+            z0[i] = flush_denormal(z0[i]);
+            z1[i] = flush_denormal(z1[i]);
+        }
+    }
+
+    float process(float x)
+    {
+        for (int i = 0; i < num; i++)
+        {
+            float theta = (x - z0[i] - z1[i] * b1[i]) * b0[i];
+            x += theta * b3[i] + z1[i] * b2[i] + z0[i] * b4[i];
+            z0[i] += theta;
+            z1[i] = -z1[i] - theta * b1[i];
+        }
+        return x;
+    }
+
+    // A sample's bands form a dependency chain, but band i of one sample
+    // and band i+1 of the previous don't, so running sample by sample lets
+    // the recursions overlap; that measures faster than band by band. in
+    // and out may be the same buffer.
+    void process_block(const float* in, float* out, int n)
+    {
+        for (int j = 0; j < n; j++)
+            out[j] = process(in[j]);
+    }
+};
+
+// Set the bands from a layout; damping scales the widths as in
+// bandpass_bank_configure. Only bands whose settings moved are recomputed.
+// Returns false when nothing changed.
+inline bool eq_bank_configure(EQBank& eq, float sample_rate, float damping,
+                              const EQLayout& layout)
+{
+    bool changed = eq.num != layout.num;
+    for (int i = eq.num; i < layout.num; i++)
+        eq.z0[i] = eq.z1[i] = 0.0f;     // bands starting up
+    eq.num = layout.num;
+    float res = damping * (1.0f / 0.707f);
+    for (int i = 0; i < layout.num; i++)
+    {
+        float d = layout.width[i] * res;
+        if (d < 0.005f) d = 0.005f;
+        if (layout.type[i] == eq.type[i] && layout.freq[i] == eq.freq[i] &&
+            d == eq.damp[i] && layout.gain[i] == eq.gain[i])
+            continue;
+        eq.type[i] = layout.type[i];
+        eq.freq[i] = layout.freq[i];
+        eq.damp[i] = d;
+        eq.gain[i] = layout.gain[i];
+
+        Filter2Coeffs c;
+        filter2_configure_eq(c, sample_rate, layout.freq[i], d, layout.gain[i],
+                             layout.type[i]);
+        eq.b0[i] = c.b0;
+        eq.b1[i] = c.b1;
+        eq.b2[i] = c.b2;
+        eq.b3[i] = c.b3;
+        eq.b4[i] = c.b4;
+        changed = true;
+    }
+    return changed;
+}
+
+// ============================================================
+// Filter modes
+// ============================================================
+
+enum Mode
+{
+    MODE_LP6 = 0,     // 1st-order low-pass
+    MODE_LP12,        // 2nd-order low-pass
+    MODE_LP24,        // cascaded 2nd-order low-pass
+    MODE_HP6,         // 1st-order high-pass
+    MODE_HP12,        // 2nd-order high-pass
+    MODE_HP24,        // cascaded 2nd-order high-pass
+    MODE_BP,          // 2nd-order band-pass
+    MODE_BP2,         // cascaded band-pass
+    MODE_NOTCH,       // 2nd-order notch
+    MODE_NOTCH2,      // cascaded notch
+    MODE_AP,          // 2nd-order all-pass
+    MODE_AP2,         // cascaded all-pass
+    MODE_LADDER,      // 4-pole nonlinear ladder
+    MODE_FORMANT,     // parallel band-pass formant bank (vowels)
+    MODE_RESON,       // parallel band-pass harmonic resonator bank
+    MODE_EQ,          // 3-4 band shelf/peak EQ
+    NUM_MODES
+};
+
+inline bool mode_is_first_order(int mode)
+{
+    return mode == MODE_LP6 || mode == MODE_HP6;
+}
+
+inline bool mode_is_bank(int mode)
+{
+    return mode == MODE_FORMANT || mode == MODE_RESON;
+}
+
+inline bool mode_is_cascade(int mode)
+{
+    return mode == MODE_LP24 || mode == MODE_HP24 || mode == MODE_BP2 ||
+           mode == MODE_NOTCH2 || mode == MODE_AP2;
+}
+
+// Through-zero FM runs a negative cutoff as its reflection |cutoff| (a
+// filter tuned below zero would be unstable). Band-pass responses are odd
+// in the cutoff, so they also change sign: -1 for modes built on a single
+// band-pass stage, 1 otherwise.
+inline float mode_thru_zero_sign(int mode)
+{
+    return (mode == MODE_BP || mode_is_bank(mode)) ? -1.0f : 1.0f;
+}
+
+// Second-order type used by a (non first-order) mode
+inline Filter2Type mode_filter2_type(int mode)
+{
+    switch (mode)
+    {
+    case MODE_HP12: case MODE_HP24: return F2_HP;
+    case MODE_BP: case MODE_BP2: return F2_BP;
+    case MODE_NOTCH: case MODE_NOTCH2: return F2_NOTCH;
+    case MODE_AP: case MODE_AP2: return F2_AP;
+    default: return F2_LP;
+    }
+}
+
+// Truncating quantizer with hysteresis. Step n>0 spans [n, n+1), step n<0
+// spans (n-1, n] and step 0 spans (-1, 1), matching (int)x. The current step
+// is held until x moves more than h past its edges. NaN and values too
+// large for an int also hold the current step.
+inline int quantize_hysteresis(float x, int current, float h)
+{
+    float lo = (float)(current > 0 ? current : current - 1);
+    float hi = (float)(current < 0 ? current : current + 1);
+    if (x > lo - h && x < hi + h)
+        return current;
+    if (!(x > -1e6f && x < 1e6f))
+        return current;
+    return (int)x;
+}
+
+// All filter state needed to run any one mode
+struct ModeFilter
+{
+    Filter1 f1;          // first-order filter (LP6/HP6)
+    Filter2 f2a, f2b;    // second-order filters (12dB modes + cascaded 24dB)
+    Filter2Terms terms;  // cached configuration terms of f2a
+    Ladder ladder;       // ladder mode
+    BandpassBank bands;  // formant / resonator modes
+    EQBank eq;           // EQ mode
+
+    void reset()
+    {
+        f1.reset(); f2a.reset(); f2b.reset(); ladder.reset(); bands.reset();
+        eq.reset();
+    }
+
+    // Flush the state of the filters a mode runs (the others hold still)
+    void flush_denormals(int mode)
+    {
+        switch (mode)
+        {
+        case MODE_LP6:
+        case MODE_HP6:
+            f1.z = flush_denormal(f1.z);
+            break;
+        case MODE_LADDER:
+            for (int i = 0; i < 4; i++)
+                ladder.s[i] = flush_denormal(ladder.s[i]);
+            break;
+        case MODE_FORMANT:
+        case MODE_RESON:
+            bands.flush_denormals();
+            break;
+        case MODE_EQ:
+            eq.flush_denormals();
+            break;
+        default:
+            f2a.z0 = flush_denormal(f2a.z0);
+            f2a.z1 = flush_denormal(f2a.z1);
+            if (mode_is_cascade(mode))
+            {
+                f2b.z0 = flush_denormal(f2b.z0);
+                f2b.z1 = flush_denormal(f2b.z1);
+            }
+            break;
+        }
+    }
+
+    float process(int mode, float x)
+    {
+        switch (mode)
+        {
+        case MODE_LP6:
+            return f1.process_lp(x);
+        case MODE_HP6:
+            return f1.process_hp(x);
+        case MODE_LADDER:
+            return ladder.process(x);
+        case MODE_FORMANT:
+        case MODE_RESON:
+            return bands.process(x);
+        case MODE_EQ:
+            return eq.process(x);
+        default:
+        {
+            Filter2Type type = mode_filter2_type(mode);
+            if (!mode_is_cascade(mode))
+                return filter2_process(f2a, x, type);
+            return filter2_cascade(f2a, f2b, x, type);
+        }
+        }
+    }
+
+    // Process a block with the currently configured coefficients
+    void process_block(int mode, const float* in, float* out, int n)
+    {
+        switch (mode)
+        {
+        case MODE_LP6:
+            f1.process_lp_block(in, out, n);
+            break;
+        case MODE_HP6:
+            f1.process_hp_block(in, out, n);
+            break;
+        case MODE_LADDER:
+            for (int i = 0; i < n; i++)
+                out[i] = ladder.process(in[i]);
+            break;
+        case MODE_FORMANT:
+        case MODE_RESON:
+            bands.process_block(in, out, n);
+            break;
+        case MODE_EQ:
+            eq.process_block(in, out, n);
+            break;
+        default:
+        {
+            Filter2Type type = mode_filter2_type(mode);
+            if (!mode_is_cascade(mode))
+                filter2_process_block(f2a, in, out, n, type);
+            else
+                filter2_cascade_block(f2a, f2b, in, out, n, type);
+            break;
+        }
+        }
+    }
+};
+
+// Configure the filters a mode uses. The bank modes take their band layout
+// from layout and the EQ mode its bands from eq (NULL leaves the bank's or
+// EQ's coefficients as they are). The EQ bands sit at fixed frequencies, so
+// the EQ ignores cutoff_hz.
+inline void mode_filter_configure(ModeFilter& m, float sample_rate,
+                                  float cutoff_hz, float damping, int mode,
+                                  const BankLayout* layout = NULL,
+                                  const EQLayout* eq = NULL)
+{
+    if (mode_is_bank(mode))
+    {
+        if (layout)
+            bandpass_bank_configure(m.bands, sample_rate, cutoff_hz, damping, *layout);
+    }
+    else if (mode == MODE_EQ)
+    {
+        if (eq)
+            eq_bank_configure(m.eq, sample_rate, damping, *eq);
+    }
+    else if (mode == MODE_LP6)
+        filter1_configure_lp(m.f1, sample_rate, cutoff_hz);
+    else if (mode == MODE_HP6)
+        filter1_configure_hp(m.f1, sample_rate, cutoff_hz);
+    else if (mode == MODE_LADDER)
+        ladder_configure(m.ladder, sample_rate, cutoff_hz, damping);
+    else
+    {
+        Filter2Type type = mode_filter2_type(mode);
+        filter2_configure_cached(m.f2a, m.terms, sample_rate, cutoff_hz, damping, type);
+        if (mode_is_cascade(mode))
+            filter2_copy_coefficients(m.f2b, m.f2a);
+    }
+}
+
+// Length of a mode transition (2ms at 48kHz)
+static const int MODE_XFADE_SAMPLES = 96;
+
+// Click-free mode switching. The new mode starts from a copy of the state
+// the old mode was running (the state update of every Filter2 type is the
+// same, so e.g. LP12 -> HP12 continues seamlessly) and the output crossfades
+// from the old mode to the new one. A requested mode starts at the next
+// mode_crossfader_configure(), so the new bank is always configured before
+// it runs; requests made mid-fade are held until the current fade completes.
+struct ModeCrossfader
+{
+    ModeFilter bank[2];
+    int cur;        // bank running the current mode
+    int mode;       // current mode
+    int prev;       // mode being faded out
+    int target;     // most recently requested mode
+    int fade;       // samples left in the crossfade (0 = idle)
+
+    BankLayout formants;    // band layout of MODE_FORMANT
+    BankLayout harmonics;   // band layout of MODE_RESON
+    EQLayout eq;            // bands of MODE_EQ
+
+    ModeCrossfader() : cur(0), mode(MODE_LP12), prev(MODE_LP12),
+                       target(MODE_LP12), fade(0)
+    {
+        formant_layout(formants, 0.0f, NUM_FORMANTS);
+        harmonic_layout(harmonics, 5);
+        static const float freq[EQ_MAX_BANDS] = { 100.0f, 8000.0f, 1000.0f, 3000.0f };
+        static const float flat[EQ_MAX_BANDS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        eq_layout(eq, 3, freq, flat);
+    }
+
+    const BankLayout* layout(int m) const
+    {
+        return m == MODE_RESON ? &harmonics : &formants;
+    }
+
+    void reset()
+    {
+        bank[0].reset(); bank[1].reset();
+        prev = mode = target;
+        fade = 0;
+    }
+
+    void set_mode(int m) { target = m; }
+
+    void begin()
+    {
+        const ModeFilter& from = bank[cur];
+        ModeFilter& to = bank[cur ^ 1];
+        to.reset();
+        if (mode_is_first_order(mode))
+            to.f1 = from.f1;
+        else if (mode == MODE_LADDER)
+            to.ladder = from.ladder;
+        else if (mode_is_bank(mode))
+            to.bands = from.bands;
+        else if (mode == MODE_EQ)
+            to.eq = from.eq;
+        else
+        {
+            to.f2a = from.f2a;
+            to.terms = from.terms;
+            if (mode_is_cascade(mode))
+                to.f2b = from.f2b;
+        }
+        cur ^= 1;
+        prev = mode;
+        mode = target;
+        fade = MODE_XFADE_SAMPLES;
+    }
+
+    void flush_denormals()
+    {
+        bank[cur].flush_denormals(mode);
+        if (fade)
+            bank[cur ^ 1].flush_denormals(prev);
+    }
+
+    float process(float x)
+    {
+        float y = bank[cur].process(mode, x);
+        if (fade)
+        {
+            float old = bank[cur ^ 1].process(prev, x);
+            y += (old - y) * ((float)fade * (1.0f / MODE_XFADE_SAMPLES));
+            --fade;
+        }
+        return y;
+    }
+
+    // Process a block (coefficients configured for the whole block). Any
+    // remaining fade runs per sample; the rest runs as a block.
+    void process_block(const float* in, float* out, int n)
+    {
+        int i = 0;
+        for (; i < n && fade; i++)
+        {
+            out[i] = process(in[i]);
+            flush_denormals();
+        }
+        if (i < n)
+        {
+            bank[cur].process_block(mode, in + i, out + i, n - i);
+            bank[cur].flush_denormals(mode);
+        }
+    }
+};
+
+// Configure the current mode (and the outgoing one while fading)
+inline void mode_crossfader_configure(ModeCrossfader& xf, float sample_rate,
+                                      float cutoff_hz, float damping)
+{
+    if (xf.fade == 0 && xf.target != xf.mode)
+        xf.begin();
+    mode_filter_configure(xf.bank[xf.cur], sample_rate, cutoff_hz, damping,
+                          xf.mode, xf.layout(xf.mode), &xf.eq);
+    if (xf.fade)
+        mode_filter_configure(xf.bank[xf.cur ^ 1], sample_rate, cutoff_hz,
+                              damping, xf.prev, xf.layout(xf.prev), &xf.eq);
+}
+
+// ============================================================
+// Fused drive -> filter -> dry/wet mix
+// ============================================================
+
+// Samples per internal chunk of the fused block functions
+static const int CHUNK_SAMPLES = 32;
+
+// Run a block through the whole Vortex chain with constant controls. The
+// filter (a ModeCrossfader or FilterChain) must already be configured. in ==
+// NULL is silence; in and out may be the same bus. replace = false adds into
+// out.
+template <class Filter>
+inline void drive_filter_mix_block(Filter& filter, const float* in, float* out,
+                                   int n, float drive, float mix, bool replace)
+{
+    float buf[CHUNK_SAMPLES];
+    float gain = 1.0f + drive * 9.0f;   // 1x to 10x gain
+
+    for (int start = 0; start < n; start += CHUNK_SAMPLES)
+    {
+        int len = n - start;
+        if (len > CHUNK_SAMPLES) len = CHUNK_SAMPLES;
+
+        // Drive
+        for (int i = 0; i < len; i++)
+        {
+            float x = in ? in[start + i] : 0.0f;
+            buf[i] = drive > 0.0f ? soft_clip(x * gain) : x;
+        }
+
+        // Filter
+        filter.process_block(buf, buf, len);
+
+        // Dry/wet mix
+        for (int i = 0; i < len; i++)
+        {
+            float dry = in ? in[start + i] : 0.0f;
+            float result = dry * (1.0f - mix) + buf[i] * mix;
+            if (replace)
+                out[start + i] = result;
+            else
+                out[start + i] += result;
+        }
+    }
+}
+
+// ============================================================
+// Filter chain
+// ============================================================
+
+static const int CHAIN_MAX_SLOTS = 4;
+
+enum ChainRouting
+{
+    CHAIN_SERIES,
+    CHAIN_PARALLEL,
+    NUM_CHAIN_ROUTINGS
+};
+
+// Up to CHAIN_MAX_SLOTS filters inside one instance, in series or in
+// parallel (averaged). Every slot follows the same modulated cutoff and
+// damping, scaled per slot by ratio. Each slot has its own mode and
+// crossfader. Signals between slots stay in local chunk buffers. With one
+// slot (and a positive cutoff) the chain is exactly slot[0].
+struct FilterChain
+{
+    ModeCrossfader slot[CHAIN_MAX_SLOTS];
+    float ratio[CHAIN_MAX_SLOTS];   // cutoff multiplier of each slot
+    int slots;                      // slots in use, 1 to CHAIN_MAX_SLOTS
+    int routing;                    // ChainRouting
+    float sign[CHAIN_MAX_SLOTS];    // output polarity (through-zero FM),
+                                    // set by filter_chain_configure
+
+    FilterChain() : slots(1), routing(CHAIN_SERIES)
+    {
+        for (int s = 0; s < CHAIN_MAX_SLOTS; s++)
+        {
+            ratio[s] = 1.0f;
+            sign[s] = 1.0f;
+        }
+    }
+
+    // Slots brought into use start from silence in their requested mode
+    void set_slots(int n)
+    {
+        for (int s = slots; s < n; s++)
+            slot[s].reset();
+        slots = n;
+    }
+
+    void flush_denormals()
+    {
+        for (int s = 0; s < slots; s++)
+            slot[s].flush_denormals();
+    }
+
+    float process(float x)
+    {
+        if (routing == CHAIN_SERIES)
+        {
+            for (int s = 0; s < slots; s++)
+                x = slot[s].process(x) * sign[s];
+            return x;
+        }
+        float sum = 0.0f;
+        for (int s = 0; s < slots; s++)
+            sum += slot[s].process(x) * sign[s];
+        return sum * (1.0f / (float)slots);
+    }
+
+    // Process a block (coefficients configured for the whole block). in
+    // and out may be the same buffer.
+    void process_block(const float* in, float* out, int n)
+    {
+        if (routing == CHAIN_SERIES || slots == 1)
+        {
+            for (int s = 0; s < slots; s++)
+            {
+                slot[s].process_block(s ? out : in, out, n);
+                if (sign[s] < 0.0f)
+                    for (int i = 0; i < n; i++)
+                        out[i] = -out[i];
+            }
+            return;
+        }
+
+        float acc[CHUNK_SAMPLES], tmp[CHUNK_SAMPLES];
+        float scale = 1.0f / (float)slots;
+        for (int start = 0; start < n; start += CHUNK_SAMPLES)
+        {
+            int len = n - start;
+            if (len > CHUNK_SAMPLES) len = CHUNK_SAMPLES;
+            for (int s = 0; s < slots; s++)
+            {
+                slot[s].process_block(in + start, tmp, len);
+                if (sign[s] < 0.0f)
+                    for (int i = 0; i < len; i++)
+                        tmp[i] = -tmp[i];
+                for (int i = 0; i < len; i++)
+                    acc[i] = s > 0 ? acc[i] + tmp[i] : tmp[i];
+            }
+            for (int i = 0; i < len; i++)
+                out[start + i] = acc[i] * scale;
+        }
+    }
+};
+
+// Configure every slot in use. A negative
+// cutoff (through-zero FM) runs each slot at its reflection, with the
+// polarity of mode_thru_zero_sign.
+inline void filter_chain_configure(FilterChain& c, float sample_rate,
+                                   float cutoff_hz, float damping)
+{
+    for (int s = 0; s < c.slots; s++)
+    {
+        float fc = cutoff_hz * c.ratio[s];
+        bool reflect = fc < 0.0f;
+        if (reflect) fc = -fc;
+        if (fc < 20.0f) fc = 20.0f;
+        if (fc > 20000.0f) fc = 20000.0f;
+        mode_crossfader_configure(c.slot[s], sample_rate, fc, damping);
+        c.sign[s] = reflect ? mode_thru_zero_sign(c.slot[s].mode) : 1.0f;
+    }
+}
+
+// ============================================================
+// Internal modulation sources
+// ============================================================
+// An LFO and an input envelope follower that run at control rate: they
+// advance once per chunk, and move the cutoff, resonance and mix a chunk at
+// a time. A patch modulated only by them needs no CV bus and keeps the
+// block kernel, with the coefficients updated once per chunk.
+
+enum LFOShape
+{
+    LFO_SINE = 0,
+    LFO_TRIANGLE,
+    LFO_SAW,          // rising ramp
+    LFO_SQUARE,
+    LFO_RANDOM,       // sample & hold: a new random level each cycle
+    NUM_LFO_SHAPES
+};
+
+// Phase-accumulator LFO, output -1 to 1
+struct LFO
+{
+    float phase;      // 0-1
+    float inc;        // phase per sample
+    int shape;
+    float held;       // LFO_RANDOM's level for this cycle
+    uint32_t seed;
+
+    LFO() : phase(0.0f), inc(0.0f), shape(LFO_SINE), held(0.0f), seed(1) {}
+};
+
+inline void lfo_configure(LFO& lfo, float rate_hz, float sample_rate)
+{
+    lfo.inc = rate_hz / sample_rate;
+}
+
+// Value at the current phase, then advance n samples
+inline float lfo_advance(LFO& lfo, int n)
+{
+    float p = lfo.phase;
+    float v;
+    switch (lfo.shape)
+    {
+    case LFO_TRIANGLE: v = p < 0.5f ? 4.0f * p - 1.0f : 3.0f - 4.0f * p; break;
+    case LFO_SAW:      v = 2.0f * p - 1.0f; break;
+    case LFO_SQUARE:   v = p < 0.5f ? 1.0f : -1.0f; break;
+    case LFO_RANDOM:   v = lfo.held; break;
+    default:           v = sinf(TWO_PI * p); break;
+    }
+
+    p += lfo.inc * (float)n;
+    if (p >= 1.0f)
+    {
+        p -= floorf(p);
+        lfo.seed = lfo.seed * 1664525u + 1013904223u;
+        lfo.held = (float)(lfo.seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+    lfo.phase = p;
+    return v;
+}
+
+// Envelope follower: the peak of each chunk, smoothed with separate attack
+// and release times. Output 0-1, reaching 1 at a 5V peak.
+struct EnvelopeFollower
+{
+    float env;
+    float attack;     // 1 / attack time in samples
+    float release;    // 1 / release time in samples
+
+    EnvelopeFollower() : env(0.0f), attack(1.0f), release(1.0f) {}
+};
+
+inline void envelope_configure(EnvelopeFollower& e, float attack_ms, float release_ms,
+                               float sample_rate)
+{
+    e.attack = 1000.0f / (attack_ms * sample_rate);
+    e.release = 1000.0f / (release_ms * sample_rate);
+}
+
+// Follow the next n samples of in (NULL = silence). NaN samples are
+// ignored and Inf reads as full level.
+inline float envelope_process(EnvelopeFollower& e, const float* in, int n)
+{
+    float peak = 0.0f;
+    if (in)
+        for (int i = 0; i < n; i++)
+        {
+            float a = fabsf(in[i]);
+            peak = a > peak ? a : peak;
+        }
+    peak *= 0.2f;
+    if (peak > 1.0f) peak = 1.0f;
+
+    float rate = peak > e.env ? e.attack : e.release;
+    e.env += (peak - e.env) * (1.0f - expf(-rate * (float)n));
+    return e.env;
+}
+
+enum ModSource { MOD_LFO = 0, MOD_ENV, NUM_MOD_SOURCES };
+enum ModDest { MOD_CUTOFF = 0, MOD_RESONANCE, MOD_MIX, NUM_MOD_DESTS };
+
+// The sources and their depths (-1 to 1) to each destination. Full depth
+// acts like a 5V CV on the matching input: +/-5 octaves of cutoff, +/-1.0
+// damping, +/-100% mix.
+struct ModMatrix
+{
+    LFO lfo;
+    EnvelopeFollower env;
+    float depth[NUM_MOD_SOURCES][NUM_MOD_DESTS];
+
+    ModMatrix()
+    {
+        for (int s = 0; s < NUM_MOD_SOURCES; s++)
+            for (int d = 0; d < NUM_MOD_DESTS; d++)
+                depth[s][d] = 0.0f;
+    }
+};
+
+inline bool mod_source_used(const ModMatrix& m, int source)
+{
+    for (int d = 0; d < NUM_MOD_DESTS; d++)
+        if (m.depth[source][d] != 0.0f)
+            return true;
+    return false;
+}
+
+inline bool mod_matrix_active(const ModMatrix& m)
+{
+    return mod_source_used(m, MOD_LFO) || mod_source_used(m, MOD_ENV);
+}
+
+// Advance the sources over the next n samples of in (NULL = silence) and
+// apply them to one chunk's cutoff (Hz), damping and mix, clamped to the
+// ranges the CVs are. The follower only runs while it has a depth.
+inline void mod_matrix_apply(ModMatrix& m, const float* in, int n,
+                             float& cutoff, float& damping, float& mix)
+{
+    float src[NUM_MOD_SOURCES];
+    src[MOD_LFO] = lfo_advance(m.lfo, n);
+    src[MOD_ENV] = mod_source_used(m, MOD_ENV) ? envelope_process(m.env, in, n) : 0.0f;
+
+    float amount[NUM_MOD_DESTS] = { 0.0f, 0.0f, 0.0f };
+    for (int s = 0; s < NUM_MOD_SOURCES; s++)
+        for (int d = 0; d < NUM_MOD_DESTS; d++)
+            amount[d] += src[s] * m.depth[s][d];
+
+    if (amount[MOD_CUTOFF] != 0.0f)
+    {
+        cutoff *= voct_to_mult(amount[MOD_CUTOFF] * 5.0f);
+        cutoff = cutoff < 20.0f ? 20.0f : cutoff;
+        cutoff = cutoff > 20000.0f ? 20000.0f : cutoff;
+    }
+    damping -= amount[MOD_RESONANCE];
+    damping = damping < 0.01f ? 0.01f : damping;
+    damping = damping > 0.707f ? 0.707f : damping;
+    mix += amount[MOD_MIX];
+    mix = mix < 0.0f ? 0.0f : mix;
+    mix = mix > 1.0f ? 1.0f : mix;
+}
+
+// ============================================================
+// Modulated processing: modulation stage -> DSP stage
+// ============================================================
+// With CVs patched, a chunk of the block is processed in two passes. The
+// modulation stage reads each connected CV bus in turn, sequentially, and
+// writes scaled and clamped per-sample controls into a ControlBlock. The
+// DSP stage then runs drive, filter and mix from those arrays, so the
+// filter loop never touches the CV buses.
+
+// Controls for one chunk, one entry per sample. cutoff and damping are
+// only filled (and read) where the coefficients are updated.
+struct ControlBlock
+{
+    float cutoff[CHUNK_SAMPLES];
+    float damping[CHUNK_SAMPLES];
+    float drive[CHUNK_SAMPLES];
+    float mix[CHUNK_SAMPLES];
+};
+
+// Cutoff every `stride` samples: base scaled by V/OCT (and by FM in
+// FM_EXP), moved by linear FM otherwise, then clamped to 20 Hz - 20 kHz
+// (through-zero FM down to -20 kHz). fast_math folds V/OCT and
+// exponential FM into one fast_exp2. voct/fm NULL = not patched.
+inline void modulate_cutoff(float* cutoff, const float* voct, const float* fm,
+                            float base, float fm_depth, int fm_mode,
+                            bool fast_math, int stride, int n)
+{
+    bool exp_fm = fm && fm_mode == FM_EXP;
+    bool lin_fm = fm && fm_mode != FM_EXP;
+    float lo = fm_mode == FM_THRU_ZERO ? -20000.0f : 20.0f;
+
+    if (fast_math)
+    {
+        for (int i = 0; i < n; i += stride)
+        {
+            float octaves = 0.0f;
+            if (voct) octaves += voct[i];
+            if (exp_fm) octaves += fm[i] * fm_depth;
+            cutoff[i] = base * fast_exp2(octaves);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < n; i += stride)
+            cutoff[i] = voct ? base * voct_to_mult(voct[i]) : base;
+        if (exp_fm)
+            for (int i = 0; i < n; i += stride)
+                cutoff[i] *= voct_to_mult(fm[i] * fm_depth);
+    }
+    if (lin_fm)
+        for (int i = 0; i < n; i += stride)
+            cutoff[i] = fm_linear(cutoff[i], fm[i] * fm_depth);
+
+    for (int i = 0; i < n; i += stride)
+    {
+        float c = cutoff[i];
+        c = c < lo ? lo : c;
+        c = c > 20000.0f ? 20000.0f : c;
+        cutoff[i] = c;
+    }
+}
+
+// base + cv * scale clamped to lo..hi, every `stride` samples. cv NULL
+// gives base as it is.
+inline void modulate_linear(float* out, const float* cv, float base, float scale,
+                            float lo, float hi, int stride, int n)
+{
+    if (!cv)
+    {
+        for (int i = 0; i < n; i += stride)
+            out[i] = base;
+        return;
+    }
+    for (int i = 0; i < n; i += stride)
+    {
+        float x = base + cv[i] * scale;
+        x = x < lo ? lo : x;
+        x = x > hi ? hi : x;
+        out[i] = x;
+    }
+}
+
+// drive_filter_mix_controls() over samples begin..end-1 of a chunk. in,
+// out and ctl are indexed from the chunk start, so a chunk run in pieces
+// updates its coefficients on the same samples as in one go. begin must
+// be an update boundary, or follow an earlier piece of the same chunk.
+inline void drive_filter_mix_controls_range(FilterChain& chain, const float* in,
+                                            float* out, int begin, int end,
+                                            const ControlBlock& ctl, int update_mask,
+                                            float sample_rate, bool replace)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if ((i & update_mask) == 0)
+            filter_chain_configure(chain, sample_rate, ctl.cutoff[i], ctl.damping[i]);
+
+        float x = in ? in[i] : 0.0f;
+
+        // Drive: 1x to 10x gain into the soft clipper
+        float drive = ctl.drive[i];
+        float signal = drive > 0.0f ? soft_clip(x * (1.0f + drive * 9.0f)) : x;
+
+        float wet = chain.process(signal);
+        chain.flush_denormals();
+
+        float mix = ctl.mix[i];
+        float result = x * (1.0f - mix) + wet * mix;
+        if (replace)
+            out[i] = result;
+        else
+            out[i] += result;
+    }
+}
+
+// DSP stage: drive -> filter chain -> dry/wet mix with per-sample controls.
+// Coefficients are updated where (i & update_mask) == 0, counting from the
+// start of in, so in must start on an update boundary. in == NULL is
+// silence; in and out may be the same bus. replace = false adds into out.
+inline void drive_filter_mix_controls(FilterChain& chain, const float* in,
+                                      float* out, int n, const ControlBlock& ctl,
+                                      int update_mask, float sample_rate, bool replace)
+{
+    drive_filter_mix_controls_range(chain, in, out, 0, n, ctl,
+                                    update_mask, sample_rate, replace);
+}
+
+// ============================================================
+// CPU governor
+// ============================================================
+
+// Quality levels, from full quality down. Each level cuts the cost of the
+// modulated (per-sample) path further.
+enum QualityLevel
+{
+    QUALITY_FULL = 0,   // coefficients every sample
+    QUALITY_CV4,        // coefficients every 4 samples
+    QUALITY_CV16,       // coefficients every 16 samples
+    QUALITY_FAST,       // ... plus approximate exp2 for the cutoff CVs
+    NUM_QUALITY_LEVELS
+};
+
+// Blocks of headroom needed before stepping back up a level
+static const int GOVERNOR_RECOVER_BLOCKS = 200;
+
+// Steps quality down as soon as a block goes over budget, and back up one
+// level only after GOVERNOR_RECOVER_BLOCKS consecutive blocks under 60% of
+// budget, so it doesn't oscillate between two levels at the boundary.
+struct Governor
+{
+    int level;
+    int headroom;   // consecutive blocks under the step-up threshold
+
+    Governor() : level(QUALITY_FULL), headroom(0) {}
+
+    void reset() { level = QUALITY_FULL; headroom = 0; }
+};
+
+// Feed one block's cycle count. budget == 0 disables the governor.
+// lowest is the lowest level that still made the block cheaper: Full with
+// no per-sample modulation, CV/16 without pitch CVs (Fast only speeds up
+// the V/OCT and FM conversion). The level never steps down past it, and a
+// level below it counts the block as headroom, so it returns once the
+// patch changes. Returns true when the level changed.
+inline bool governor_update(Governor& g, uint32_t cycles, uint32_t budget,
+                            int lowest = NUM_QUALITY_LEVELS - 1)
+{
+    int old = g.level;
+    if (budget == 0)
+    {
+        g.reset();
+    }
+    else if (g.level > lowest)
+    {
+        if (++g.headroom >= GOVERNOR_RECOVER_BLOCKS)
+        {
+            --g.level;
+            g.headroom = 0;
+        }
+    }
+    else if (cycles > budget)
+    {
+        if (g.level < lowest)
+            ++g.level;
+        g.headroom = 0;
+    }
+    else if (g.level > QUALITY_FULL && (uint64_t)cycles * 5 < (uint64_t)budget * 3)
+    {
+        if (++g.headroom >= GOVERNOR_RECOVER_BLOCKS)
+        {
+            --g.level;
+            g.headroom = 0;
+        }
+    }
+    else
+    {
+        g.headroom = 0;
+    }
+    return g.level != old;
+}
+
+// Samples between coefficient updates at a quality level (a power of two)
+inline int quality_update_interval(int level)
+{
+    return level >= QUALITY_CV16 ? 16 : level == QUALITY_CV4 ? 4 : 1;
+}
+
 } // namespace vortex
@@ -0,0 +1,512 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+
+#include "../dsp.h"
+
+// Desktop benchmarks for the per-sample filter paths. Each case runs a full
+// second of audio with the cutoff swept every sample, so coefficients are
+// recomputed per sample exactly as step() does with a V/OCT CV patched.
+// Absolute numbers are host-specific; compare cases against each other.
+
+static const float kSampleRate = 48000.0f;
+static const int kFrames = 48000;
+static const int kRepeats = 20;
+
+static float input[kFrames];
+static float cutoff[kFrames];
+static float output[kFrames];
+static float fmSignal[kFrames];
+static float cvs[7][kFrames];   // V/OCT, FM, Res, Mode, Drive, Mix, Vowel
+
+// Benchmark macros (same shape as the test macros)
+static double baseline_ns = 0.0;
+
+#define BENCH(name) \
+    static void bench_##name(); \
+    static void run_##name() { \
+        bench_##name(); \
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now(); \
+        for (int r = 0; r < kRepeats; r++) \
+            bench_##name(); \
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now(); \
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() \
+                    / ((double)kRepeats * kFrames); \
+        if (baseline_ns == 0.0) baseline_ns = ns; \
+        printf("  %-28s %7.2f ns/sample  %5.2fx\n", #name, ns, ns / baseline_ns); \
+    } \
+    static void bench_##name()
+
+static void init_signals()
+{
+    unsigned seed = 1;
+    for (int i = 0; i < kFrames; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (float)(seed >> 8) / 8388608.0f - 1.0f;
+        input[i] = 0.5f * sinf(2.0f * vortex::PI * 110.0f * (float)i / kSampleRate)
+                 + 0.1f * noise;
+        // 1 Hz sweep over 50 Hz - 5 kHz
+        float sweep = 0.5f + 0.5f * sinf(2.0f * vortex::PI * (float)i / kSampleRate);
+        cutoff[i] = 50.0f * powf(100.0f, sweep);
+        // 220 Hz modulator, 2V peak
+        fmSignal[i] = 2.0f * sinf(2.0f * vortex::PI * 220.0f * (float)i / kSampleRate);
+        // Slow CVs (a few Hz, different rates) plus a little noise
+        for (int c = 0; c < 7; c++)
+            cvs[c][i] = sinf(2.0f * vortex::PI * (0.5f + (float)c) * (float)i / kSampleRate)
+                      + 0.01f * noise;
+    }
+}
+
+// --- Cases ---
+
+// Reference: the LP 24dB cascade as step() runs it
+BENCH(lp24_cascade)
+{
+    vortex::Filter2 a, b;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure(a, kSampleRate, cutoff[i], 0.3f, vortex::F2_LP);
+        vortex::filter2_configure(b, kSampleRate, cutoff[i], 0.3f, vortex::F2_LP);
+        float y = a.process_lna(input[i]);
+        output[i] = b.process_lna(y);
+    }
+}
+
+// Second stage copies the first stage's coefficients
+BENCH(lp24_shared_coeffs)
+{
+    vortex::Filter2 a, b;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure(a, kSampleRate, cutoff[i], 0.3f, vortex::F2_LP);
+        vortex::filter2_copy_coefficients(b, a);
+        output[i] = vortex::filter2_cascade(a, b, input[i], vortex::F2_LP);
+    }
+}
+
+// Cascade recursions alone (coefficients fixed), where the serial
+// dependency chain dominates
+BENCH(lp24_fixed_serial)
+{
+    vortex::Filter2 a, b;
+    vortex::filter2_configure(a, kSampleRate, 1000.0f, 0.3f, vortex::F2_LP);
+    vortex::filter2_copy_coefficients(b, a);
+    for (int i = 0; i < kFrames; i++)
+        output[i] = vortex::filter2_cascade(a, b, input[i], vortex::F2_LP);
+}
+
+BENCH(lp12)
+{
+    vortex::Filter2 a;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure(a, kSampleRate, cutoff[i], 0.3f, vortex::F2_LP);
+        output[i] = a.process_lna(input[i]);
+    }
+}
+
+BENCH(ladder)
+{
+    vortex::Ladder f;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::ladder_configure(f, kSampleRate, cutoff[i], 0.3f);
+        output[i] = f.process(input[i]);
+    }
+}
+
+// --- Coefficient computation alone ---
+
+static vortex::Filter2Coeffs coeffs;
+
+// Read every sample, so the compiler can't hoist the cutoff terms of a full
+// configure out of the loop (step() can't either: the cutoff may move)
+static volatile float fixedCutoff = 1000.0f;
+
+// Cutoff moves every sample (V/OCT CV)
+BENCH(coeffs_full_cutoff)
+{
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure(coeffs, kSampleRate, cutoff[i], 0.3f, vortex::F2_LP);
+        output[i] = coeffs.b0;
+    }
+}
+
+BENCH(coeffs_cached_cutoff)
+{
+    vortex::Filter2Terms terms;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure_cached(coeffs, terms, kSampleRate, cutoff[i], 0.3f,
+                                         vortex::F2_LP);
+        output[i] = coeffs.b0;
+    }
+}
+
+// Damping moves every sample (Resonance CV)
+BENCH(coeffs_full_damping)
+{
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure(coeffs, kSampleRate, fixedCutoff, cutoff[i] * 0.0001f,
+                                  vortex::F2_LP);
+        output[i] = coeffs.b0;
+    }
+}
+
+BENCH(coeffs_cached_damping)
+{
+    vortex::Filter2Terms terms;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure_cached(coeffs, terms, kSampleRate, fixedCutoff,
+                                         cutoff[i] * 0.0001f, vortex::F2_LP);
+        output[i] = coeffs.b0;
+    }
+}
+
+// Type changes every sample, cutoff and damping fixed
+BENCH(coeffs_cached_type)
+{
+    vortex::Filter2Terms terms;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure_cached(coeffs, terms, kSampleRate, fixedCutoff, 0.3f,
+                                         (vortex::Filter2Type)(i & 1));
+        output[i] = coeffs.b2;
+    }
+}
+
+// Nothing changes
+BENCH(coeffs_cached_static)
+{
+    vortex::Filter2Terms terms;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter2_configure_cached(coeffs, terms, kSampleRate, fixedCutoff, 0.3f,
+                                         vortex::F2_LP);
+        output[i] = coeffs.b0;
+    }
+}
+
+// --- Audio-rate FM (LP12, cutoff and coefficients per sample) ---
+
+BENCH(fm_exp)
+{
+    static vortex::FilterChain chain;
+    for (int i = 0; i < kFrames; i++) {
+        float fc = 1000.0f * vortex::voct_to_mult(fmSignal[i]);
+        vortex::filter_chain_configure(chain, kSampleRate, fc, 0.3f);
+        output[i] = chain.process(input[i]);
+    }
+}
+
+BENCH(fm_linear)
+{
+    static vortex::FilterChain chain;
+    for (int i = 0; i < kFrames; i++) {
+        float fc = vortex::fm_linear(1000.0f, fmSignal[i]);
+        if (fc < 20.0f) fc = 20.0f;
+        vortex::filter_chain_configure(chain, kSampleRate, fc, 0.3f);
+        output[i] = chain.process(input[i]);
+    }
+}
+
+BENCH(fm_thru_zero)
+{
+    static vortex::FilterChain chain;
+    for (int i = 0; i < kFrames; i++) {
+        vortex::filter_chain_configure(chain, kSampleRate,
+                                       vortex::fm_linear(1000.0f, fmSignal[i]), 0.3f);
+        output[i] = chain.process(input[i]);
+    }
+}
+
+// --- Block processing (constant controls) ---
+
+// Whole chain per sample, reconfiguring every sample as step() used to
+BENCH(chain_per_sample)
+{
+    static vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_LP24);
+    for (int i = 0; i < kFrames; i++) {
+        vortex::mode_crossfader_configure(xf, kSampleRate, 1000.0f, 0.3f);
+        float x = vortex::soft_clip(input[i] * 3.0f);
+        float wet = xf.process(x);
+        xf.flush_denormals();
+        output[i] = input[i] * 0.2f + wet * 0.8f;
+    }
+}
+
+// Fused drive/filter/mix kernel, configured once per 24-sample block
+BENCH(chain_fused_block)
+{
+    static vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_LP24);
+    for (int i = 0; i < kFrames; i += 24) {
+        vortex::mode_crossfader_configure(xf, kSampleRate, 1000.0f, 0.3f);
+        vortex::drive_filter_mix_block(xf, input + i, output + i, 24,
+                                       0.2222f, 0.8f, true);
+    }
+}
+
+// --- Two filters (LP24 into HP12, constant controls) ---
+// Both cases drive the input once, run the same two filters and mix once
+// against the same dry input; only where the signal between the filters
+// lives differs.
+static float bus[kFrames];
+// Two filters passing the signal through a bus, as two instances would
+BENCH(two_instances)
+{
+    static vortex::ModeCrossfader a, b;
+    a.set_mode(vortex::MODE_LP24);
+    b.set_mode(vortex::MODE_HP12);
+    float gain = 1.0f + 0.2222f * 9.0f;
+    for (int i = 0; i < kFrames; i += 24) {
+        vortex::mode_crossfader_configure(a, kSampleRate, 2000.0f, 0.3f);
+        vortex::mode_crossfader_configure(b, kSampleRate, 200.0f, 0.3f);
+        for (int j = i; j < i + 24; j++)
+            bus[j] = vortex::soft_clip(input[j] * gain);
+        a.process_block(bus + i, bus + i, 24);
+        b.process_block(bus + i, bus + i, 24);
+        for (int j = i; j < i + 24; j++)
+            output[j] = input[j] * 0.2f + bus[j] * 0.8f;
+    }
+}
+// One instance with a two-slot series chain
+BENCH(chain_two_slots)
+{
+    static vortex::FilterChain chain;
+    chain.slot[0].set_mode(vortex::MODE_LP24);
+    chain.slot[1].set_mode(vortex::MODE_HP12);
+    chain.ratio[1] = 0.1f;
+    chain.set_slots(2);
+    for (int i = 0; i < kFrames; i += 24) {
+        vortex::filter_chain_configure(chain, kSampleRate, 2000.0f, 0.3f);
+        vortex::drive_filter_mix_block(chain, input + i, output + i, 24,
+                                       0.2222f, 0.8f, true);
+    }
+}
+
+// --- All seven CVs patched (LP24, 24-sample blocks) ---
+// V/OCT, FM, Resonance, Drive and Mix per sample; Mode and Vowel averaged
+// per block, as step() reads them.
+
+static volatile float blockCvSink;
+
+static void average_block_cvs(int start, int n)
+{
+    float mode = 0.0f, vowel = 0.0f;
+    for (int i = 0; i < n; i++) {
+        mode += cvs[3][start + i];
+        vowel += cvs[6][start + i];
+    }
+    blockCvSink = mode + vowel;
+}
+
+// CV reads, scaling and clamps interleaved with the filter, sample by sample
+BENCH(cv_interleaved)
+{
+    static vortex::FilterChain chain;
+    chain.slot[0].set_mode(vortex::MODE_LP24);
+    for (int start = 0; start < kFrames; start += 24) {
+        average_block_cvs(start, 24);
+        for (int i = start; i < start + 24; i++) {
+            float fc = 1000.0f * vortex::voct_to_mult(cvs[0][i])
+                     * vortex::voct_to_mult(cvs[1][i] * 0.5f);
+            if (fc < 20.0f) fc = 20.0f;
+            if (fc > 20000.0f) fc = 20000.0f;
+            float damping = 0.3f - cvs[2][i] * 0.2f;
+            if (damping < 0.01f) damping = 0.01f;
+            if (damping > 0.707f) damping = 0.707f;
+            vortex::filter_chain_configure(chain, kSampleRate, fc, damping);
+            float drive = 0.2f + cvs[4][i] * 0.2f;
+            if (drive < 0.0f) drive = 0.0f;
+            if (drive > 1.0f) drive = 1.0f;
+            float mix = 0.8f + cvs[5][i] * 0.2f;
+            if (mix < 0.0f) mix = 0.0f;
+            if (mix > 1.0f) mix = 1.0f;
+            float x = input[i];
+            float signal = drive > 0.0f ? vortex::soft_clip(x * (1.0f + drive * 9.0f)) : x;
+            float wet = chain.process(signal);
+            chain.flush_denormals();
+            output[i] = x * (1.0f - mix) + wet * mix;
+        }
+    }
+}
+
+// Modulation stage into a ControlBlock, then the DSP stage
+BENCH(cv_prepass)
+{
+    static vortex::FilterChain chain;
+    vortex::ControlBlock ctl;
+    chain.slot[0].set_mode(vortex::MODE_LP24);
+    for (int start = 0; start < kFrames; start += 24) {
+        average_block_cvs(start, 24);
+        vortex::modulate_cutoff(ctl.cutoff, cvs[0] + start, cvs[1] + start, 1000.0f,
+                                0.5f, vortex::FM_EXP, false, 1, 24);
+        vortex::modulate_linear(ctl.damping, cvs[2] + start, 0.3f, -0.2f, 0.01f, 0.707f, 1, 24);
+        vortex::modulate_linear(ctl.drive, cvs[4] + start, 0.2f, 0.2f, 0.0f, 1.0f, 1, 24);
+        vortex::modulate_linear(ctl.mix, cvs[5] + start, 0.8f, 0.2f, 0.0f, 1.0f, 1, 24);
+        vortex::drive_filter_mix_controls(chain, input + start, output + start, 24,
+                                          ctl, 0, kSampleRate, true);
+    }
+}
+
+// --- Band-pass bank (8 bands, constant controls) ---
+
+// Eight separate Filter2 band-passes, summed
+BENCH(bank_separate_filter2)
+{
+    static vortex::Filter2 f[8];
+    for (int b = 0; b < 8; b++)
+        vortex::filter2_configure(f[b], kSampleRate, 200.0f * (float)(b + 1), 0.05f,
+                                  vortex::F2_BP);
+    for (int i = 0; i < kFrames; i++) {
+        float y = 0.0f;
+        for (int b = 0; b < 8; b++)
+            y += f[b].process_hb(input[i]);
+        output[i] = y;
+    }
+}
+
+// Struct-of-arrays bank
+BENCH(bank_soa)
+{
+    static vortex::BandpassBank bank;
+    vortex::BankLayout layout;
+    vortex::harmonic_layout(layout, 8);
+    vortex::bandpass_bank_configure(bank, kSampleRate, 200.0f, 0.5f, layout);
+    bank.process_block(input, output, kFrames);
+}
+
+// --- 4-band EQ (constant settings, 24-sample blocks) ---
+
+static const float kEQFreq[4] = { 120.0f, 7000.0f, 800.0f, 2500.0f };
+static const float kEQGainDb[4] = { 6.0f, -9.0f, -12.0f, 4.0f };
+
+// Four separate shelf/peak sections, each configured every block as a
+// stack of single-band filters would be
+BENCH(eq_separate_filter2)
+{
+    static vortex::Filter2 f[4];
+    static vortex::EQLayout layout;
+    vortex::eq_layout(layout, 4, kEQFreq, kEQGainDb);
+    for (int i = 0; i < kFrames; i += 24) {
+        const float* src = input + i;
+        for (int b = 0; b < 4; b++) {
+            vortex::filter2_configure_eq(f[b], kSampleRate, layout.freq[b], layout.width[b],
+                                         layout.gain[b], layout.type[b]);
+            vortex::filter2_process_block(f[b], src, output + i, 24, layout.type[b]);
+            src = output + i;
+        }
+    }
+}
+
+// EQ mode: one filter, coefficients only recomputed on a change
+BENCH(eq_mode)
+{
+    static vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_EQ);
+    vortex::eq_layout(xf.eq, 4, kEQFreq, kEQGainDb);
+    for (int i = 0; i < kFrames; i += 24) {
+        vortex::mode_crossfader_configure(xf, kSampleRate, 1000.0f, 0.707f);
+        vortex::drive_filter_mix_block(xf, input + i, output + i, 24,
+                                       0.0f, 1.0f, true);
+    }
+}
+
+// --- LP24 swept by a 1 Hz sine (24-sample blocks) ---
+
+// The sweep on a CV bus: per-sample cutoff through the modulated path
+BENCH(sweep_cv_bus)
+{
+    static vortex::FilterChain chain;
+    vortex::ControlBlock ctl;
+    chain.slot[0].set_mode(vortex::MODE_LP24);
+    for (int start = 0; start < kFrames; start += 24) {
+        vortex::modulate_cutoff(ctl.cutoff, cvs[0] + start, NULL, 1000.0f,
+                                0.0f, vortex::FM_EXP, false, 1, 24);
+        vortex::modulate_linear(ctl.damping, NULL, 0.3f, -0.2f, 0.01f, 0.707f, 1, 24);
+        vortex::modulate_linear(ctl.drive, NULL, 0.0f, 0.2f, 0.0f, 1.0f, 1, 24);
+        vortex::modulate_linear(ctl.mix, NULL, 1.0f, 0.2f, 0.0f, 1.0f, 1, 24);
+        vortex::drive_filter_mix_controls(chain, input + start, output + start, 24,
+                                          ctl, 0, kSampleRate, true);
+    }
+}
+
+// The internal LFO: coefficients once per chunk, block kernel
+BENCH(sweep_internal_lfo)
+{
+    static vortex::FilterChain chain;
+    static vortex::ModMatrix mods;
+    chain.slot[0].set_mode(vortex::MODE_LP24);
+    vortex::lfo_configure(mods.lfo, 1.0f, kSampleRate);
+    mods.depth[vortex::MOD_LFO][vortex::MOD_CUTOFF] = 0.2f;
+    for (int start = 0; start < kFrames; start += 24) {
+        float fc = 1000.0f, damping = 0.3f, mix = 1.0f;
+        vortex::mod_matrix_apply(mods, input + start, 24, fc, damping, mix);
+        vortex::filter_chain_configure(chain, kSampleRate, fc, damping);
+        vortex::drive_filter_mix_block(chain, input + start, output + start, 24,
+                                       0.0f, mix, true);
+    }
+}
+
+int main()
+{
+    printf("Vortex DSP Benchmarks\n");
+    printf("=====================\n\n");
+
+    init_signals();
+
+    printf("Filters (swept cutoff, per-sample coefficients):\n");
+    run_lp24_cascade();
+    run_lp24_shared_coeffs();
+    run_lp24_fixed_serial();
+    run_lp12();
+    run_ladder();
+
+    printf("\nFilter2 coefficients (relative to a full configure):\n");
+    baseline_ns = 0.0;
+    run_coeffs_full_cutoff();
+    run_coeffs_cached_cutoff();
+    run_coeffs_full_damping();
+    run_coeffs_cached_damping();
+    run_coeffs_cached_type();
+    run_coeffs_cached_static();
+
+    printf("\nAudio-rate cutoff FM, LP12:\n");
+    baseline_ns = 0.0;
+    run_fm_exp();
+    run_fm_linear();
+    run_fm_thru_zero();
+
+    printf("\nLP24 chain, constant controls:\n");
+    baseline_ns = 0.0;
+    run_chain_per_sample();
+    run_chain_fused_block();
+
+    printf("\nLP24 into HP12, constant controls:\n");
+    baseline_ns = 0.0;
+    run_two_instances();
+    run_chain_two_slots();
+
+    printf("\nLP24, all seven CVs patched:\n");
+    baseline_ns = 0.0;
+    run_cv_interleaved();
+    run_cv_prepass();
+
+    printf("\nBand-pass bank, 8 bands:\n");
+    baseline_ns = 0.0;
+    run_bank_separate_filter2();
+    run_bank_soa();
+
+    printf("\n4-band EQ, constant settings:\n");
+    baseline_ns = 0.0;
+    run_eq_separate_filter2();
+    run_eq_mode();
+
+    printf("\nLP24 swept by a 1 Hz sine:\n");
+    baseline_ns = 0.0;
+    run_sweep_cv_bus();
+    run_sweep_internal_lfo();
+
+    // Keep the output live so the loops are not optimised away
+    float sum = 0.0f;
+    for (int i = 0; i < kFrames; i++)
+        sum += output[i];
+    printf("\n(checksum %f)\n", (double)sum);
+    return 0;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+// Desktop emulation of the parts of the Disting NT API that vortex.cpp
+// uses, so the plugin itself can run on a host (trace_dump, stress_step).
+// Include once, after ../vortex.cpp, in the program's only translation unit.
+//
+// Buses are laid out as on the NT: bus n (1-based) occupies numFrames
+// floats starting at (n - 1) * numFrames.
+
+static const int kHostMaxFrames = 128;
+static const int kHostNumBusses = 28;
+static const int kHostMaxParams = 256;
+static const uint32_t kHostMidiOutSize = 1 << 18;
+
+const _NT_globals NT_globals = {
+    .sampleRate = 48000,
+    .maxFramesPerStep = kHostMaxFrames,
+};
+
+struct NtHost
+{
+    const _NT_factory* factory;
+    _NT_algorithm* alg;
+    int numParams;
+    int16_t v[kHostMaxParams];
+    uint8_t* sram;
+    uint8_t* dram;
+
+    float bus[kHostNumBusses * kHostMaxFrames];
+
+    // Everything sent with NT_sendMidiByte
+    uint8_t midiOut[kHostMidiOutSize];
+    uint32_t midiOutLen;
+};
+
+static NtHost ntHost;
+
+// --- API functions ---
+
+int NT_floatToString( char* buffer, float value, int decimalPlaces )
+{
+    return sprintf( buffer, "%.*f", decimalPlaces, (double)value );
+}
+
+int NT_intToString( char* buffer, int32_t value )
+{
+    return sprintf( buffer, "%d", (int)value );
+}
+
+uint32_t NT_algorithmIndex( const _NT_algorithm* algorithm )
+{
+    return 0;
+}
+
+uint32_t NT_parameterOffset( void )
+{
+    return 0;
+}
+
+void NT_setParameterFromAudio( uint32_t algorithmIndex, uint32_t parameter, int16_t value )
+{
+    ntHost.v[parameter] = value;
+    ntHost.factory->parameterChanged( ntHost.alg, parameter );
+}
+
+void NT_setParameterFromUi( uint32_t algorithmIndex, uint32_t parameter, int16_t value )
+{
+    NT_setParameterFromAudio( algorithmIndex, parameter, value );
+}
+
+// Host "cycles" are nanoseconds
+uint32_t NT_getCpuCycleCount( void )
+{
+    static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0 ).count();
+}
+
+void NT_sendMidiByte( uint32_t destination, uint8_t b )
+{
+    if ( ntHost.midiOutLen < kHostMidiOutSize )
+        ntHost.midiOut[ntHost.midiOutLen++] = b;
+}
+
+// --- Host control ---
+
+// Construct the plugin's first factory with default parameter values,
+// replacing any instance loaded before
+static inline bool nt_host_load()
+{
+    free( ntHost.sram );
+    free( ntHost.dram );
+    memset( &ntHost, 0, sizeof( ntHost ) );
+    ntHost.factory = (const _NT_factory*)pluginEntry( kNT_selector_factoryInfo, 0 );
+    if ( !ntHost.factory )
+        return false;
+
+    _NT_algorithmRequirements req;
+    memset( &req, 0, sizeof( req ) );
+    ntHost.factory->calculateRequirements( req, NULL );
+    if ( req.numParameters > (uint32_t)kHostMaxParams )
+        return false;
+    ntHost.numParams = req.numParameters;
+    ntHost.sram = (uint8_t*)calloc( 1, req.sram );
+    ntHost.dram = req.dram ? (uint8_t*)calloc( 1, req.dram ) : NULL;
+
+    _NT_algorithmMemoryPtrs ptrs;
+    memset( &ptrs, 0, sizeof( ptrs ) );
+    ptrs.sram = ntHost.sram;
+    ptrs.dram = ntHost.dram;
+    ntHost.alg = ntHost.factory->construct( ptrs, req, NULL );
+    ntHost.alg->vIncludingCommon = ntHost.v;
+    ntHost.alg->v = ntHost.v;
+
+    for ( int i = 0; i < ntHost.numParams; ++i )
+    {
+        ntHost.v[i] = ntHost.alg->parameters[i].def;
+        ntHost.factory->parameterChanged( ntHost.alg, i );
+    }
+    return true;
+}
+
+static inline void nt_host_set_parameter( int parameter, int16_t value )
+{
+    ntHost.v[parameter] = value;
+    ntHost.factory->parameterChanged( ntHost.alg, parameter );
+}
+
+// Frames of a bus (1-based) for a block of numFrames
+static inline float* nt_host_bus( int bus, int numFrames )
+{
+    return ntHost.bus + ( bus - 1 ) * numFrames;
+}
+
+static inline void nt_host_step( int numFrames )
+{
+    ntHost.factory->step( ntHost.alg, ntHost.bus, numFrames / 4 );
+}
+
+static inline void nt_host_sysex( const uint8_t* msg, int len )
+{
+    if ( !ntHost.factory->midiSysEx )
+        return;
+    for ( int i = 0; i < len; ++i )
+        ntHost.factory->midiSysEx( msg[i], i == len - 1 );
+}
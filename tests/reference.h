@@ -0,0 +1,379 @@
+#pragma once
+
+#include <math.h>
+
+// Double-precision reference model of the full Vortex chain:
+// drive -> filter (every mode) -> dry/wet mix.
+//
+// This is a straight, unoptimized restatement of the algorithms in dsp.h,
+// written independently in double precision. It shares no code with dsp.h,
+// so optimized float paths can be checked against it (see test_reference.cpp).
+
+namespace vortex_ref {
+
+static const double PI = 3.14159265358979323846;
+static const double SQRT2 = 1.41421356237309504880;
+static const double INV_PI = 0.31830988618379067154;
+static const double INV_SQRT2 = 0.70710678118654752440;
+
+enum Mode
+{
+    LP6 = 0, LP12, LP24, HP6, HP12, HP24, BP, BP2, NOTCH, NOTCH2, AP, AP2,
+    LADDER, FORMANT, RESON, EQ, NUM_MODES
+};
+
+inline double soft_clip(double x)
+{
+    double x2 = x * x;
+    return x * (27.0 + x2) / (27.0 + 9.0 * x2);
+}
+
+// --- First order ---
+
+struct Filter1
+{
+    double z, b0, b1;
+    bool hp;
+
+    Filter1() : z(0.0), b0(0.0), b1(0.0), hp(false) {}
+
+    void configure(double fs, double fc, bool highpass)
+    {
+        double w = fs / (2.0 * PI * fc);
+        double sigma = INV_PI;
+        if (w > INV_PI)
+            sigma = 0.40824999 * (0.05843357 - w * w) / (0.04593294 - w * w);
+        double v = sqrt(w * w + sigma * sigma);
+        b0 = 1.0 / (0.5 + v);
+        b1 = highpass ? w : 0.5 + sigma;
+        hp = highpass;
+    }
+
+    double process(double x)
+    {
+        double theta = (x - z) * b0;
+        double y = hp ? theta * b1 : theta * b1 + z;
+        z += theta;
+        return y;
+    }
+};
+
+// --- Second order ---
+
+enum Type { T_LP, T_HP, T_BP, T_NOTCH, T_AP };
+
+struct Filter2
+{
+    double z0, z1, b0, b1, b2, b3;
+    bool with_z0;   // LP, notch and all-pass outputs include z0
+
+    Filter2() : z0(0.0), z1(0.0), b0(0.0), b1(0.0), b2(0.0), b3(0.0), with_z0(true) {}
+
+    void configure(double fs, double fc, double damping, Type type)
+    {
+        double w = fs / (SQRT2 * PI * fc);
+        double sigma = SQRT2 * INV_PI;
+        if (w > INV_PI * SQRT2)
+            sigma = 0.57735268 * (0.11686715 - w * w) / (0.09186588 - w * w);
+        double w_sq = w * w, sigma_sq = sigma * sigma;
+        double t = w_sq * (2.0 * damping * damping - 1.0);
+        double v = sqrt(w_sq * w_sq + sigma_sq * (2.0 * t + sigma_sq));
+        double k = t + sigma_sq;
+        b0 = 1.0 / (v + sqrt(v + k) + 0.5);
+        b1 = sqrt(2.0 * v);
+        with_z0 = true;
+        switch (type)
+        {
+        case T_LP:
+            b2 = 2.0 * sigma_sq / b1;
+            b3 = 0.5 + sigma_sq + SQRT2 * sigma;
+            break;
+        case T_HP:
+            b2 = 2.0 * w_sq / b1;
+            b3 = w_sq;
+            with_z0 = false;
+            break;
+        case T_BP:
+            b2 = 4.0 * w * damping * sigma / b1;
+            b3 = 2.0 * w * damping * (sigma + INV_SQRT2);
+            with_z0 = false;
+            break;
+        case T_NOTCH:
+            b2 = 2.0 * (w_sq - sigma_sq) / b1;
+            b3 = 0.5 + w_sq - sigma_sq;
+            break;
+        case T_AP:
+            b2 = b1;
+            b3 = 0.5 + v - sqrt(v + k);
+            break;
+        }
+    }
+
+    double process(double x)
+    {
+        double theta = (x - z0 - z1 * b1) * b0;
+        double y = theta * b3 + z1 * b2 + (with_z0 ? z0 : 0.0);
+        z0 += theta;
+        z1 = -z1 - theta * b1;
+        return y;
+    }
+};
+
+// --- Ladder (same one-step linearized ZDF solve as dsp.h) ---
+
+inline double tanh_ratio(double x)
+{
+    double x2 = x * x;
+    if (x2 >= 9.0)
+        return 1.0 / fabs(x);
+    return (27.0 + x2) / (27.0 + 9.0 * x2);
+}
+
+struct Ladder
+{
+    double s[4], g, k;
+
+    Ladder() : g(0.0), k(0.0) { s[0] = s[1] = s[2] = s[3] = 0.0; }
+
+    void configure(double fs, double fc, double damping)
+    {
+        if (fc > 0.49 * fs)
+            fc = 0.49 * fs;
+        g = tan(PI * fc / fs);
+        k = 4.0 * (0.707 - damping) / (0.707 - 0.01);
+    }
+
+    double process(double x)
+    {
+        double a[4] = { tanh_ratio(x - k * s[3]), tanh_ratio(s[0]),
+                        tanh_ratio(s[1]), tanh_ratio(s[2]) };
+        double G[4], S[4];
+        for (int i = 0; i < 4; i++) {
+            double d = 1.0 / (1.0 + g * tanh_ratio(s[i]));
+            G[i] = g * a[i] * d;
+            S[i] = s[i] * d;
+        }
+        double Gt = G[0] * G[1] * G[2] * G[3];
+        double St = G[3] * (G[2] * (G[1] * S[0] + S[1]) + S[2]) + S[3];
+        double y3 = (Gt * x + St) / (1.0 + k * Gt);
+        double y = x - k * y3;
+        for (int i = 0; i < 3; i++) {
+            y = G[i] * y + S[i];
+            s[i] = 2.0 * y - s[i];
+        }
+        s[3] = 2.0 * y3 - s[3];
+        return y3;
+    }
+};
+
+// --- Band-pass bank ---
+
+static const int MAX_BANDS = 8;
+
+// Band i at cutoff * ratio[i], damping width[i] * damping / 0.707, gain[i]
+struct Layout
+{
+    int num;
+    double ratio[MAX_BANDS], width[MAX_BANDS], gain[MAX_BANDS];
+
+    Layout() : num(0) {}
+};
+
+struct Bank
+{
+    Filter2 band[MAX_BANDS];
+
+    double process(double x, double fs, double cutoff, double damping,
+                   const Layout& layout)
+    {
+        double y = 0.0;
+        for (int i = 0; i < layout.num; i++)
+        {
+            // Bands above 0.45 fs keep running at 0.45 fs, muted
+            double f = cutoff * layout.ratio[i];
+            double g = layout.gain[i];
+            if (f > 0.45 * fs)
+            {
+                f = 0.45 * fs;
+                g = 0.0;
+            }
+            double d = layout.width[i] * damping / 0.707;
+            if (d < 0.005)
+                d = 0.005;
+            band[i].configure(fs, f, d, T_BP);
+            y += g * band[i].process(x);
+        }
+        return y;
+    }
+};
+
+// --- Multi-band EQ ---
+
+static const int MAX_EQ_BANDS = 4;
+
+enum EQType { LOW_SHELF, HIGH_SHELF, PEAK };
+
+// One shelf/peak section: the RBJ audio EQ cookbook biquad, direct form I
+struct EQBand
+{
+    double b0, b1, b2, a1, a2;      // normalized by a0
+    double x1, x2, y1, y2;
+
+    EQBand() : b0(1.0), b1(0.0), b2(0.0), a1(0.0), a2(0.0),
+               x1(0.0), x2(0.0), y1(0.0), y2(0.0) {}
+
+    // gain is linear; damping = 1/(2Q)
+    void configure(double fs, EQType type, double freq, double damping, double gain)
+    {
+        if (freq > 0.45 * fs)
+            freq = 0.45 * fs;
+        double A = sqrt(gain);
+        double w0 = 2.0 * PI * freq / fs;
+        double cw = cos(w0);
+        double alpha = sin(w0) * damping;   // sin(w0) / (2Q)
+        double sa = 2.0 * sqrt(A) * alpha;
+        double c0, c1, c2, d0, d1, d2;
+        if (type == LOW_SHELF)
+        {
+            c0 = A * ((A + 1.0) - (A - 1.0) * cw + sa);
+            c1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * cw);
+            c2 = A * ((A + 1.0) - (A - 1.0) * cw - sa);
+            d0 = (A + 1.0) + (A - 1.0) * cw + sa;
+            d1 = -2.0 * ((A - 1.0) + (A + 1.0) * cw);
+            d2 = (A + 1.0) + (A - 1.0) * cw - sa;
+        }
+        else if (type == HIGH_SHELF)
+        {
+            c0 = A * ((A + 1.0) + (A - 1.0) * cw + sa);
+            c1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * cw);
+            c2 = A * ((A + 1.0) + (A - 1.0) * cw - sa);
+            d0 = (A + 1.0) - (A - 1.0) * cw + sa;
+            d1 = 2.0 * ((A - 1.0) - (A + 1.0) * cw);
+            d2 = (A + 1.0) - (A - 1.0) * cw - sa;
+        }
+        else
+        {
+            c0 = 1.0 + alpha * A;
+            c1 = -2.0 * cw;
+            c2 = 1.0 - alpha * A;
+            d0 = 1.0 + alpha / A;
+            d1 = -2.0 * cw;
+            d2 = 1.0 - alpha / A;
+        }
+        b0 = c0 / d0; b1 = c1 / d0; b2 = c2 / d0;
+        a1 = d1 / d0; a2 = d2 / d0;
+    }
+
+    double process(double x)
+    {
+        double y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1; x1 = x;
+        y2 = y1; y1 = y;
+        return y;
+    }
+};
+
+// Band i: type[i] at freq[i] Hz, gain[i] (linear), damping
+// width[i] * damping / 0.707
+struct EQLayout
+{
+    int num;
+    EQType type[MAX_EQ_BANDS];
+    double freq[MAX_EQ_BANDS], width[MAX_EQ_BANDS], gain[MAX_EQ_BANDS];
+
+    EQLayout() : num(0) {}
+};
+
+struct Equalizer
+{
+    EQBand band[MAX_EQ_BANDS];
+
+    double process(double x, double fs, double damping, const EQLayout& layout)
+    {
+        for (int i = 0; i < layout.num; i++)
+        {
+            double d = layout.width[i] * damping / 0.707;
+            if (d < 0.005)
+                d = 0.005;
+            band[i].configure(fs, layout.type[i], layout.freq[i], d, layout.gain[i]);
+            x = band[i].process(x);
+        }
+        return x;
+    }
+};
+
+// --- Full chain ---
+
+inline bool is_cascade(int mode)
+{
+    return mode == LP24 || mode == HP24 || mode == BP2 || mode == NOTCH2 || mode == AP2;
+}
+
+inline Type type_of(int mode)
+{
+    switch (mode)
+    {
+    case HP12: case HP24: return T_HP;
+    case BP: case BP2: return T_BP;
+    case NOTCH: case NOTCH2: return T_NOTCH;
+    case AP: case AP2: return T_AP;
+    default: return T_LP;
+    }
+}
+
+struct Chain
+{
+    int mode;
+    Filter1 f1;
+    Filter2 a, b;
+    Ladder ladder;
+    Bank bank;
+    Layout layout;
+    Equalizer eq;
+    EQLayout eq_layout;
+
+    explicit Chain(int m, const Layout& l = Layout(), const EQLayout& e = EQLayout())
+        : mode(m), layout(l), eq_layout(e) {}
+
+    // One sample with per-sample controls (coefficients recomputed each call)
+    double process(double x, double fs, double cutoff, double damping,
+                   double drive, double mix)
+    {
+        double dry = x;
+        if (drive > 0.0)
+            x = soft_clip(x * (1.0 + drive * 9.0));
+
+        double wet;
+        if (mode == LP6 || mode == HP6)
+        {
+            f1.configure(fs, cutoff, mode == HP6);
+            wet = f1.process(x);
+        }
+        else if (mode == FORMANT || mode == RESON)
+        {
+            wet = bank.process(x, fs, cutoff, damping, layout);
+        }
+        else if (mode == EQ)
+        {
+            wet = eq.process(x, fs, damping, eq_layout);
+        }
+        else if (mode == LADDER)
+        {
+            ladder.configure(fs, cutoff, damping);
+            wet = ladder.process(x);
+        }
+        else
+        {
+            a.configure(fs, cutoff, damping, type_of(mode));
+            wet = a.process(x);
+            if (is_cascade(mode))
+            {
+                b.configure(fs, cutoff, damping, type_of(mode));
+                wet = b.process(wet);
+            }
+        }
+        return dry * (1.0 - mix) + wet * mix;
+    }
+};
+
+} // namespace vortex_ref
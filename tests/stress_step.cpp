@@ -0,0 +1,462 @@
+#include <math.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include "../vortex.cpp"
+#include "nt_host.h"
+
+// Worst-case step() harness (host). Average cost matters less than the
+// worst block, because one overrun is an audible glitch.
+//
+//   stress_step [-t trials] [-b budget_ns] [-o dir]
+//                       search every configuration for the input that makes
+//                       one step() slowest, report the worst block per
+//                       configuration and save its input to dir (default
+//                       stress_worst/). With -b, fail if any worst block
+//                       exceeds budget_ns.
+//   stress_step file.stim
+//                       replay a saved input and report its block times
+//
+// Each trial generates a stimulus (audio and every CV input) from a
+// scenario and a seed, with random Cutoff/Resonance/Drive/FM Depth, and runs
+// it through a freshly loaded plugin. The whole trial is run kRepeats times
+// and each block keeps its fastest time, so host interrupts and scheduling
+// don't show up as worst cases. Times are host nanoseconds; compare them
+// against each other, not against the NT's budget.
+
+static const int kFrames = 32;
+static const int kBlocks = 48;
+static const int kRepeats = 3;
+static const int kDefaultTrials = 60;
+
+// Bus assignment: audio in on 1, CVs on 2-8, output on 9
+enum
+{
+    kBusAudio = 1,
+    kBusVOCT, kBusFM, kBusResonance, kBusMode, kBusDrive, kBusMix, kBusVowel,
+    kBusOut,
+    kNumStimBusses = kBusVowel
+};
+
+// --- Scenarios ---
+
+enum Scenario
+{
+    kScenarioNoise,       // noise audio, random CVs
+    kScenarioNyquist,     // every CV flipping between the rails each sample
+    kScenarioModeFlip,    // Mode and Vowel CV flipping every block
+    kScenarioDenormal,    // loud burst, then denormal-level decay
+    kScenarioNaN,         // NaN/Inf bursts in audio and CV, then clean
+    kScenarioExtreme,     // controls and CVs pinned at their limits
+    kNumScenarios
+};
+
+static const char* scenarioNames[kNumScenarios] = {
+    "noise", "nyquist", "mode-flip", "denormal", "nan", "extreme"
+};
+
+// --- Configurations ---
+
+struct ParamSetting
+{
+    int param;
+    int16_t value;
+};
+
+struct StressConfig
+{
+    const char* name;
+    bool cvs;                     // patch the CV inputs (per-sample path)
+    ParamSetting settings[10];    // terminated by param < 0
+};
+
+static const StressConfig configs[] = {
+    { "lp24-static", false, { { kParamMode, vortex::MODE_LP24 }, { -1, 0 } } },
+    { "lp24",        true,  { { kParamMode, vortex::MODE_LP24 }, { -1, 0 } } },
+    { "notch2",      true,  { { kParamMode, vortex::MODE_NOTCH2 }, { -1, 0 } } },
+    { "ladder",      true,  { { kParamMode, vortex::MODE_LADDER }, { -1, 0 } } },
+    { "formant8",    true,  { { kParamMode, vortex::MODE_FORMANT }, { kParamBands, 8 },
+                              { -1, 0 } } },
+    { "reson8",      true,  { { kParamMode, vortex::MODE_RESON }, { kParamBands, 8 },
+                              { -1, 0 } } },
+    { "eq4",         true,  { { kParamMode, vortex::MODE_EQ }, { kParamEQBands, 4 },
+                              { kParamEQLowGain, 120 }, { kParamEQMidGain, -180 },
+                              { kParamEQMid2Gain, 90 }, { -1, 0 } } },
+    { "auto-wah",    false, { { kParamMode, vortex::MODE_BP2 }, { kParamEnvAttack, 1 },
+                              { kParamEnvCutoff, 800 }, { kParamLFOShape, vortex::LFO_RANDOM },
+                              { kParamLFORate, 2000 }, { kParamLFOCutoff, 200 },
+                              { -1, 0 } } },
+    { "thru-zero",   true,  { { kParamMode, vortex::MODE_BP2 },
+                              { kParamFMMode, vortex::FM_THRU_ZERO }, { -1, 0 } } },
+    { "chain4-series", true, { { kParamMode, vortex::MODE_LP24 }, { kParamSlots, 4 },
+                               { kParamSlot2Mode, vortex::MODE_HP24 },
+                               { kParamSlot3Mode, vortex::MODE_RESON },
+                               { kParamSlot4Mode, vortex::MODE_LADDER },
+                               { kParamSlot3Offset, 12 }, { kParamBands, 8 },
+                               { -1, 0 } } },
+    { "chain4-parallel", true, { { kParamMode, vortex::MODE_BP2 }, { kParamSlots, 4 },
+                                 { kParamRouting, vortex::CHAIN_PARALLEL },
+                                 { kParamSlot2Mode, vortex::MODE_FORMANT },
+                                 { kParamSlot3Mode, vortex::MODE_NOTCH2 },
+                                 { kParamSlot4Mode, vortex::MODE_LADDER },
+                                 { kParamSlot2Offset, -12 }, { kParamBands, 8 },
+                                 { -1, 0 } } },
+};
+
+static const int kNumConfigs = (int)( sizeof( configs ) / sizeof( configs[0] ) );
+
+// --- Stimulus ---
+
+struct Stimulus
+{
+    int numParams;
+    int params[kHostMaxParams];
+    int16_t values[kHostMaxParams];
+    float bus[kBlocks][kNumStimBusses][kFrames];   // buses 1 to kNumStimBusses
+    bool cvs;
+};
+
+static Stimulus stim;
+
+struct Rng
+{
+    uint32_t state;
+
+    float uniform()   // -1 to 1
+    {
+        state = state * 1664525u + 1013904223u;
+        return (float)( state >> 8 ) / 8388608.0f - 1.0f;
+    }
+
+    int below( int n )
+    {
+        return (int)( ( uniform() * 0.5f + 0.5f ) * (float)n ) % n;
+    }
+};
+
+static void stim_param( int param, int16_t value )
+{
+    stim.params[stim.numParams] = param;
+    stim.values[stim.numParams] = value;
+    ++stim.numParams;
+}
+
+static void generate( const StressConfig& config, int scenario, uint32_t seed )
+{
+    Rng rng = { seed };
+    stim.numParams = 0;
+    stim.cvs = config.cvs;
+
+    stim_param( kParamInput, kBusAudio );
+    stim_param( kParamOutput, kBusOut );
+    stim_param( kParamOutputMode, 1 );
+    if ( config.cvs )
+    {
+        stim_param( kParamCVCutoffVOCT, kBusVOCT );
+        stim_param( kParamCVCutoffFM, kBusFM );
+        stim_param( kParamCVResonance, kBusResonance );
+        stim_param( kParamCVMode, kBusMode );
+        stim_param( kParamCVDrive, kBusDrive );
+        stim_param( kParamCVMix, kBusMix );
+        stim_param( kParamCVVowel, kBusVowel );
+    }
+    for ( const ParamSetting* s = config.settings; s->param >= 0; ++s )
+        stim_param( s->param, s->value );
+
+    if ( scenario == kScenarioExtreme )
+    {
+        stim_param( kParamCutoff, rng.below( 2 ) ? 1000 : 0 );
+        stim_param( kParamResonance, 1000 );
+        stim_param( kParamDrive, 1000 );
+        stim_param( kParamFMDepth, rng.below( 2 ) ? 1000 : -1000 );
+    }
+    else
+    {
+        stim_param( kParamCutoff, (int16_t)rng.below( 1001 ) );
+        stim_param( kParamResonance, (int16_t)( 500 + rng.below( 501 ) ) );
+        stim_param( kParamDrive, (int16_t)rng.below( 1001 ) );
+        stim_param( kParamFMDepth, (int16_t)( rng.below( 2001 ) - 1000 ) );
+    }
+
+    for ( int b = 0; b < kBlocks; ++b )
+    {
+        float (*bus)[kFrames] = stim.bus[b];
+        for ( int i = 0; i < kFrames; ++i )
+        {
+            float alt = ( i & 1 ) ? 1.0f : -1.0f;
+            float flip = ( b & 1 ) ? 5.0f : -5.0f;
+            float audio = rng.uniform();
+            float cv[kNumStimBusses];
+            for ( int c = 1; c < kNumStimBusses; ++c )
+                cv[c] = 5.0f * rng.uniform();
+
+            switch ( scenario )
+            {
+            case kScenarioNyquist:
+                audio = alt;
+                for ( int c = 1; c < kNumStimBusses; ++c )
+                    cv[c] = 5.0f * alt;
+                cv[kBusMode - 1] = flip;
+                break;
+            case kScenarioModeFlip:
+                cv[kBusMode - 1] = flip;
+                cv[kBusVowel - 1] = ( b & 1 ) ? 4.0f : 0.0f;
+                break;
+            case kScenarioDenormal:
+                // Burst, then input decaying through the denormal range
+                if ( b >= 4 )
+                    audio *= 1e-30f * powf( 1e-3f, (float)( b - 4 ) / 8.0f );
+                for ( int c = 1; c < kNumStimBusses; ++c )
+                    cv[c] = 0.0f;
+                break;
+            case kScenarioNaN:
+                // Bursts in blocks 8-15 only, to see whether the filter
+                // recovers afterwards
+                if ( b >= 8 && b < 16 && rng.below( 16 ) == 0 )
+                {
+                    float bad = rng.below( 2 ) ? NAN : INFINITY;
+                    if ( rng.below( 2 ) )
+                        audio = bad;
+                    else
+                        cv[1 + rng.below( kNumStimBusses - 1 )] = bad;
+                }
+                break;
+            case kScenarioExtreme:
+                cv[kBusVOCT - 1] = flip;
+                cv[kBusFM - 1] = 5.0f * sinf( (float)( b * kFrames + i ) * 0.7f );
+                cv[kBusResonance - 1] = 5.0f;
+                cv[kBusDrive - 1] = 5.0f;
+                cv[kBusMix - 1] = 5.0f;
+                break;
+            }
+
+            bus[0][i] = audio;
+            for ( int c = 1; c < kNumStimBusses; ++c )
+                bus[c][i] = cv[c];
+        }
+    }
+}
+
+// --- Running ---
+
+struct Result
+{
+    uint32_t blockNs[kBlocks];   // fastest of kRepeats, per block
+    bool finiteAtEnd;            // output finite in the last block
+};
+
+static void load_stimulus()
+{
+    nt_host_load();
+    for ( int n = 0; n < stim.numParams; ++n )
+        nt_host_set_parameter( stim.params[n], stim.values[n] );
+}
+
+static void run( Result& r )
+{
+    for ( int b = 0; b < kBlocks; ++b )
+        r.blockNs[b] = 0xFFFFFFFFu;
+
+    for ( int rep = 0; rep < kRepeats; ++rep )
+    {
+        load_stimulus();
+        for ( int b = 0; b < kBlocks; ++b )
+        {
+            for ( int c = 0; c < kNumStimBusses; ++c )
+                memcpy( nt_host_bus( c + 1, kFrames ), stim.bus[b][c], sizeof( stim.bus[b][c] ) );
+            uint32_t start = NT_getCpuCycleCount();
+            nt_host_step( kFrames );
+            uint32_t ns = NT_getCpuCycleCount() - start;
+            if ( ns < r.blockNs[b] )
+                r.blockNs[b] = ns;
+        }
+    }
+
+    const float* out = nt_host_bus( kBusOut, kFrames );
+    r.finiteAtEnd = true;
+    for ( int i = 0; i < kFrames; ++i )
+        if ( !isfinite( out[i] ) )
+            r.finiteAtEnd = false;
+}
+
+static int worst_block( const Result& r )
+{
+    int w = 0;
+    for ( int b = 1; b < kBlocks; ++b )
+        if ( r.blockNs[b] > r.blockNs[w] )
+            w = b;
+    return w;
+}
+
+// --- Saved inputs ---
+// Text, one value per token, floats as hex so NaN/Inf/denormals survive:
+//   vortex-stress <config> <scenario> <seed> <worst block> <worst ns>
+//   cvs <0|1>
+//   param <index> <value>      (repeated)
+//   block <n>                  (then kNumStimBusses lines of kFrames values)
+
+static bool save( const char* path, const char* config, int scenario, uint32_t seed,
+                  int block, uint32_t ns )
+{
+    FILE* fp = fopen( path, "w" );
+    if ( !fp )
+        return false;
+    fprintf( fp, "vortex-stress %s %s %u %d %u\n", config, scenarioNames[scenario],
+             seed, block, ns );
+    fprintf( fp, "cvs %d\n", stim.cvs ? 1 : 0 );
+    for ( int n = 0; n < stim.numParams; ++n )
+        fprintf( fp, "param %d %d\n", stim.params[n], (int)stim.values[n] );
+    for ( int b = 0; b < kBlocks; ++b )
+    {
+        fprintf( fp, "block %d\n", b );
+        for ( int c = 0; c < kNumStimBusses; ++c )
+        {
+            for ( int i = 0; i < kFrames; ++i )
+                fprintf( fp, i ? " %a" : "%a", (double)stim.bus[b][c][i] );
+            fprintf( fp, "\n" );
+        }
+    }
+    fclose( fp );
+    return true;
+}
+
+static bool load( const char* path )
+{
+    FILE* fp = fopen( path, "r" );
+    if ( !fp )
+        return false;
+    char line[64];
+    bool ok = fgets( line, sizeof( line ), fp ) && !strncmp( line, "vortex-stress ", 14 );
+    int cvs = 0;
+    ok = ok && fscanf( fp, " cvs %d", &cvs ) == 1;
+    stim.cvs = cvs != 0;
+    stim.numParams = 0;
+    int param, value;
+    while ( ok && fscanf( fp, " param %d %d", &param, &value ) == 2 )
+        stim_param( param, (int16_t)value );
+    for ( int b = 0; ok && b < kBlocks; ++b )
+    {
+        int n;
+        ok = fscanf( fp, " block %d", &n ) == 1 && n == b;
+        for ( int c = 0; ok && c < kNumStimBusses; ++c )
+            for ( int i = 0; ok && i < kFrames; ++i )
+            {
+                char tok[48];
+                ok = fscanf( fp, " %47s", tok ) == 1;
+                stim.bus[b][c][i] = strtof( tok, NULL );
+            }
+    }
+    fclose( fp );
+    return ok;
+}
+
+static int replay( const char* path )
+{
+    if ( !load( path ) )
+    {
+        fprintf( stderr, "%s: not a stress input\n", path );
+        return 1;
+    }
+    Result r;
+    run( r );
+    printf( "block,ns\n" );
+    for ( int b = 0; b < kBlocks; ++b )
+        printf( "%d,%u\n", b, r.blockNs[b] );
+    int w = worst_block( r );
+    fprintf( stderr, "worst block %d: %u ns%s\n", w, r.blockNs[w],
+             r.finiteAtEnd ? "" : " (output not finite at end)" );
+    return 0;
+}
+
+// --- Search ---
+
+static int search( int trials, uint32_t budgetNs, const char* dir )
+{
+    mkdir( dir, 0755 );
+    printf( "Vortex step() worst case, %d-frame blocks, %d trials per configuration\n",
+            kFrames, trials );
+    printf( "(host ns, fastest of %d runs per block)\n\n", kRepeats );
+    printf( "  %-16s %9s %9s %7s  %-10s %s\n", "config", "mean", "worst", "ratio",
+            "scenario", "NaN" );
+
+    int failures = 0;
+    for ( int ci = 0; ci < kNumConfigs; ++ci )
+    {
+        const StressConfig& config = configs[ci];
+        double sum = 0.0;
+        uint32_t worstNs = 0;
+        int worstScenario = 0, worstBlock = 0;
+        uint32_t worstSeed = 0;
+        bool nanRecovers = true;
+
+        for ( int t = 0; t < trials; ++t )
+        {
+            int scenario = t % kNumScenarios;
+            uint32_t seed = 1000u * (uint32_t)ci + (uint32_t)t + 1u;
+            generate( config, scenario, seed );
+            Result r;
+            run( r );
+            for ( int b = 0; b < kBlocks; ++b )
+                sum += r.blockNs[b];
+            if ( scenario == kScenarioNaN && !r.finiteAtEnd )
+                nanRecovers = false;
+            int w = worst_block( r );
+            if ( r.blockNs[w] > worstNs )
+            {
+                worstNs = r.blockNs[w];
+                worstScenario = scenario;
+                worstBlock = w;
+                worstSeed = seed;
+            }
+        }
+
+        double mean = sum / ( (double)trials * kBlocks );
+        bool over = budgetNs && worstNs > budgetNs;
+        if ( over )
+            ++failures;
+        printf( "  %-16s %9.0f %9u %6.1fx  %-10s %s%s\n", config.name, mean, worstNs,
+                worstNs / mean, scenarioNames[worstScenario],
+                nanRecovers ? "recovers" : "latches", over ? "  OVER BUDGET" : "" );
+
+        // Save the offending input
+        char path[256];
+        snprintf( path, sizeof( path ), "%s/%s.stim", dir, config.name );
+        generate( config, worstScenario, worstSeed );
+        if ( !save( path, config.name, worstScenario, worstSeed, worstBlock, worstNs ) )
+            fprintf( stderr, "can't write %s\n", path );
+    }
+
+    printf( "\nWorst inputs saved to %s/ (replay with: stress_step <file>)\n", dir );
+    if ( failures )
+    {
+        printf( "%d configuration(s) over the %u ns budget\n", failures, budgetNs );
+        return 1;
+    }
+    return 0;
+}
+
+int main( int argc, char** argv )
+{
+    int trials = kDefaultTrials;
+    uint32_t budgetNs = 0;
+    const char* dir = "stress_worst";
+
+    for ( int a = 1; a < argc; ++a )
+    {
+        if ( !strcmp( argv[a], "-t" ) && a + 1 < argc )
+            trials = atoi( argv[++a] );
+        else if ( !strcmp( argv[a], "-b" ) && a + 1 < argc )
+            budgetNs = (uint32_t)atoi( argv[++a] );
+        else if ( !strcmp( argv[a], "-o" ) && a + 1 < argc )
+            dir = argv[++a];
+        else if ( argv[a][0] != '-' )
+            return replay( argv[a] );
+        else
+        {
+            fprintf( stderr, "usage: stress_step [-t trials] [-b budget_ns] [-o dir] | file.stim\n" );
+            return 1;
+        }
+    }
+    if ( trials < 1 )
+        trials = 1;
+    return search( trials, budgetNs, dir );
+}
@@ -31,6 +31,29 @@ static int tests_passed = 0;
     } } while(0)
 
 #include "../dsp.h"
+#include "../trace.h"
+
+// --- Helpers ---
+
+static void fill_noise(float* buf, int n, unsigned seed)
+{
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        buf[i] = (float)(seed >> 8) / 8388608.0f - 1.0f;
+    }
+}
+
+// Steady-state peak output of a crossfader for a unit sine at freq
+static float measure_mode_gain(vortex::ModeCrossfader& xf, float freq)
+{
+    float peak = 0.0f;
+    for (int i = 0; i < 48000; i++) {
+        float y = xf.process(sinf(2.0f * vortex::PI * freq * (float)i / 48000.0f));
+        if (i > 24000 && fabsf(y) > peak)
+            peak = fabsf(y);
+    }
+    return peak;
+}
 
 // --- Utility tests ---
 
@@ -98,6 +121,14 @@ TEST(flush_denormal_zero)
     ASSERT_NEAR(vortex::flush_denormal(0.0f), 0.0f, 1e-6f);
 }
 
+TEST(flush_denormal_non_finite)
+{
+    ASSERT(vortex::flush_denormal(1e-40f) == 0.0f);
+    ASSERT(vortex::flush_denormal(NAN) == 0.0f);
+    ASSERT(vortex::flush_denormal(-INFINITY) == 0.0f);
+    ASSERT(vortex::flush_denormal(-3e38f) == -3e38f);
+}
+
 TEST(cutoff_param_to_hz_min)
 {
     // param 0 -> 20 Hz
@@ -129,6 +160,50 @@ TEST(resonance_to_damping_max)
     ASSERT(d > 0.0f && d < 0.02f);
 }
 
+TEST(cutoff_table_matches_powf)
+{
+    // Compile-time table agrees with the closed form at every step
+    for (int i = 0; i <= 1000; i++) {
+        float ref = 20.0f * powf(1000.0f, (float)i / 1000.0f);
+        ASSERT_NEAR(vortex::cutoff_param_to_hz(i) / ref, 1.0f, 1e-5f);
+    }
+}
+
+TEST(cutoff_table_is_constexpr)
+{
+    static_assert(vortex::CUTOFF_TABLE.v[0] > 19.99f && vortex::CUTOFF_TABLE.v[0] < 20.01f,
+                  "cutoff table evaluated at compile time");
+    static_assert(vortex::resonance_to_damping(0) > 0.706f, "damping is constexpr");
+    ASSERT(true);
+}
+
+TEST(note_table_matches_powf)
+{
+    for (int n = 0; n < 128; n++)
+        ASSERT_NEAR(vortex::midi_note_to_freq_table(n) / vortex::midi_note_to_freq((float)n),
+                    1.0f, 1e-5f);
+    ASSERT_NEAR(vortex::midi_note_to_freq_table(69), 440.0f, 0.001f);
+}
+
+TEST(keytrack_mult_full_and_off)
+{
+    // Full tracking: one octave per octave about C4
+    ASSERT_NEAR(vortex::keytrack_mult(60, 1.0f), 1.0f, 1e-5f);
+    ASSERT_NEAR(vortex::keytrack_mult(72, 1.0f), 2.0f, 1e-4f);
+    ASSERT_NEAR(vortex::keytrack_mult(48, 1.0f), 0.5f, 1e-4f);
+    // No tracking
+    ASSERT_NEAR(vortex::keytrack_mult(100, 0.0f), 1.0f, 1e-5f);
+}
+
+TEST(keytrack_mult_partial)
+{
+    // Fractional notes interpolate between table entries
+    for (int n = 0; n < 128; n++) {
+        float ref = powf(2.0f, (float)(n - 60) * 0.5f / 12.0f);
+        ASSERT_NEAR(vortex::keytrack_mult(n, 0.5f) / ref, 1.0f, 5e-4f);
+    }
+}
+
 // --- First-order filter tests ---
 
 TEST(filter1_lp_passes_dc)
@@ -330,6 +405,1257 @@ TEST(filter2_reset)
     ASSERT_NEAR(f.z1, 0.0f, 1e-6f);
 }
 
+TEST(filter2_copy_coefficients_matches_configure)
+{
+    vortex::Filter2 a, b, c;
+    vortex::filter2_configure(a, 48000.0f, 1234.0f, 0.4f, vortex::F2_NOTCH);
+    vortex::filter2_configure(b, 48000.0f, 1234.0f, 0.4f, vortex::F2_NOTCH);
+    vortex::filter2_copy_coefficients(c, a);
+    ASSERT(c.b0 == b.b0 && c.b1 == b.b1 && c.b2 == b.b2 && c.b3 == b.b3);
+}
+
+TEST(filter2_configure_cached_matches_full)
+{
+    // Any mix of cutoff-only, damping-only and type-only changes gives
+    // exactly the coefficients of a full configure
+    vortex::Filter2Coeffs cached, full;
+    vortex::Filter2Terms terms;
+    float cutoff = 1000.0f, damping = 0.5f;
+    int type = vortex::F2_LP;
+    unsigned seed = 17;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        switch ((seed >> 16) % 3) {
+        case 0: cutoff = 20.0f + (float)((seed >> 4) % 19980); break;
+        case 1: damping = 0.01f + 0.001f * (float)((seed >> 4) % 697); break;
+        case 2: type = (int)((seed >> 4) % 5); break;
+        }
+        vortex::filter2_configure_cached(cached, terms, 48000.0f, cutoff, damping,
+                                         (vortex::Filter2Type)type);
+        vortex::filter2_configure(full, 48000.0f, cutoff, damping, (vortex::Filter2Type)type);
+        ASSERT(cached.b0 == full.b0 && cached.b1 == full.b1);
+        ASSERT(cached.b2 == full.b2 && cached.b3 == full.b3);
+    }
+}
+
+TEST(filter2_configure_cached_skips_unchanged)
+{
+    vortex::Filter2Coeffs c;
+    vortex::Filter2Terms terms;
+    ASSERT(vortex::filter2_configure_cached(c, terms, 48000.0f, 500.0f, 0.3f, vortex::F2_BP));
+    c.b0 = -1.0f;
+    ASSERT(!vortex::filter2_configure_cached(c, terms, 48000.0f, 500.0f, 0.3f, vortex::F2_BP));
+    ASSERT(c.b0 == -1.0f);
+    // Type change redoes only b2/b3
+    ASSERT(vortex::filter2_configure_cached(c, terms, 48000.0f, 500.0f, 0.3f, vortex::F2_HP));
+    ASSERT(c.b0 == -1.0f);
+}
+
+// --- Ladder filter tests ---
+
+TEST(ladder_passes_dc)
+{
+    // Without resonance the ladder has unity DC gain
+    vortex::Ladder f;
+    vortex::ladder_configure(f, 48000.0f, 1000.0f, 0.707f);
+    float out = 0.0f;
+    for (int i = 0; i < 4800; i++)
+        out = f.process(0.1f);
+    ASSERT_NEAR(out, 0.1f, 0.0001f);
+}
+
+TEST(ladder_attenuates_high_freq)
+{
+    // 4-pole: steeper than the 2nd-order filter's < 0.01 at the same point
+    vortex::Ladder f;
+    vortex::ladder_configure(f, 48000.0f, 100.0f, 0.707f);
+    float maxOut = 0.0f;
+    for (int i = 0; i < 4800; i++) {
+        float in = sinf(2.0f * vortex::PI * 10000.0f * (float)i / 48000.0f);
+        float out = f.process(in);
+        if (i > 4320)
+            if (fabsf(out) > maxOut) maxOut = fabsf(out);
+    }
+    ASSERT(maxOut < 0.0001f);
+}
+
+TEST(ladder_resonance_peak)
+{
+    vortex::Ladder f;
+    float cutoff = 1000.0f;
+    vortex::ladder_configure(f, 48000.0f, cutoff, 0.01f);
+    float maxOut = 0.0f;
+    for (int i = 0; i < 9600; i++) {
+        float in = sinf(2.0f * vortex::PI * cutoff * (float)i / 48000.0f) * 0.1f;
+        float out = f.process(in);
+        if (i > 4800)
+            if (fabsf(out) > maxOut) maxOut = fabsf(out);
+    }
+    ASSERT(maxOut > 0.1f);
+}
+
+TEST(ladder_bounded_when_driven_hard)
+{
+    // Saturation keeps full resonance with a hot input bounded
+    vortex::Ladder f;
+    vortex::ladder_configure(f, 48000.0f, 20000.0f, 0.01f);
+    float maxOut = 0.0f;
+    for (int i = 0; i < 48000; i++) {
+        float in = 10.0f * sinf(2.0f * vortex::PI * 5000.0f * (float)i / 48000.0f);
+        float out = f.process(in);
+        ASSERT(out == out);
+        if (fabsf(out) > maxOut) maxOut = fabsf(out);
+    }
+    ASSERT(maxOut < 3.0f);
+}
+
+TEST(ladder_reset)
+{
+    vortex::Ladder f;
+    vortex::ladder_configure(f, 48000.0f, 1000.0f, 0.3f);
+    for (int i = 0; i < 100; i++) f.process(1.0f);
+    f.reset();
+    for (int i = 0; i < 4; i++)
+        ASSERT_NEAR(f.s[i], 0.0f, 1e-6f);
+}
+
+// --- Band-pass bank tests ---
+
+TEST(bank_matches_parallel_filter2)
+{
+    vortex::BankLayout layout;
+    layout.num = 3;
+    float ratio[3] = { 1.0f, 2.5f, 4.0f };
+    float gain[3] = { 1.0f, 0.5f, 0.25f };
+    for (int i = 0; i < 3; i++) {
+        layout.ratio[i] = ratio[i];
+        layout.width[i] = 0.2f;
+        layout.gain[i] = gain[i];
+    }
+    vortex::BandpassBank bank;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 500.0f, 0.707f, layout);
+
+    vortex::Filter2 f[3];
+    for (int i = 0; i < 3; i++)
+        vortex::filter2_configure(f[i], 48000.0f, 500.0f * ratio[i], 0.2f, vortex::F2_BP);
+
+    float in[256];
+    fill_noise(in, 256, 3);
+    for (int n = 0; n < 256; n++) {
+        float ref = 0.0f;
+        for (int i = 0; i < 3; i++)
+            ref += gain[i] * vortex::filter2_process(f[i], in[n], vortex::F2_BP);
+        ASSERT_NEAR(bank.process(in[n]), ref, 1e-5f);
+    }
+}
+
+TEST(bank_updates_only_moved_bands)
+{
+    vortex::BankLayout layout;
+    vortex::harmonic_layout(layout, 4);
+    vortex::BandpassBank bank;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 200.0f, 0.1f, layout);
+
+    // Mark two bands, then move only band 2
+    bank.b0[1] = -1.0f;
+    bank.b0[2] = -1.0f;
+    layout.ratio[2] = 3.5f;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 200.0f, 0.1f, layout);
+    ASSERT(bank.b0[1] == -1.0f);
+    ASSERT(bank.b0[2] > 0.0f);
+}
+
+TEST(bank_skips_bands_past_num)
+{
+    // Dropping bands clears them once; a cutoff move then leaves them alone
+    vortex::BankLayout layout;
+    vortex::harmonic_layout(layout, 8);
+    vortex::BandpassBank bank;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 200.0f, 0.1f, layout);
+    for (int i = 0; i < 64; i++) bank.process(1.0f);
+    vortex::harmonic_layout(layout, 3);
+    vortex::bandpass_bank_configure(bank, 48000.0f, 200.0f, 0.1f, layout);
+    ASSERT(bank.num == 3);
+    for (int i = 3; i < 8; i++)
+        ASSERT(bank.b0[i] == 0.0f && bank.b3[i] == 0.0f && bank.z0[i] == 0.0f);
+    bank.b0[5] = -1.0f;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 300.0f, 0.1f, layout);
+    ASSERT(bank.b0[5] == -1.0f);
+    ASSERT(bank.freq[0] == 300.0f);
+}
+
+TEST(bank_mutes_bands_above_nyquist_margin)
+{
+    vortex::BankLayout layout;
+    vortex::harmonic_layout(layout, 8);
+    vortex::BandpassBank bank;
+    vortex::bandpass_bank_configure(bank, 48000.0f, 5000.0f, 0.1f, layout);
+    // Harmonics 5-8 (25-40 kHz) are past 0.45 * 48 kHz
+    for (int i = 0; i < 4; i++)
+        ASSERT(bank.b3[i] != 0.0f);
+    for (int i = 4; i < 8; i++)
+        ASSERT(bank.b2[i] == 0.0f && bank.b3[i] == 0.0f);
+}
+
+TEST(formant_layout_interpolates_vowels)
+{
+    vortex::BankLayout a, e, ae;
+    vortex::formant_layout(a, 0.0f, 5);
+    vortex::formant_layout(e, 1.0f, 5);
+    vortex::formant_layout(ae, 0.5f, 5);
+    ASSERT(ae.num == 5);
+    ASSERT_NEAR(a.ratio[0] * vortex::FORMANT_REF_HZ, 600.0f, 0.01f);
+    ASSERT_NEAR(ae.ratio[1], 0.5f * (a.ratio[1] + e.ratio[1]), 1e-5f);
+    ASSERT_NEAR(a.gain[0], 1.0f, 1e-6f);
+    // Fewer bands than formants drops the highest ones
+    vortex::BankLayout three;
+    vortex::formant_layout(three, 0.0f, 3);
+    ASSERT(three.num == 3 && three.gain[3] == 0.0f);
+}
+
+TEST(formant_mode_peaks_at_first_formant)
+{
+    // Vowel A at the reference cutoff: F1 (600 Hz) passes at about unity,
+    // a frequency between formants is well down
+    vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_FORMANT);
+    xf.reset();
+    vortex::mode_crossfader_configure(xf, 48000.0f, vortex::FORMANT_REF_HZ, 0.707f);
+    float f1 = measure_mode_gain(xf, 600.0f);
+    float gap = measure_mode_gain(xf, 5000.0f);
+    ASSERT(f1 > 0.8f && f1 < 1.3f);
+    ASSERT(gap < 0.1f);
+}
+
+// --- Shelf / peak EQ tests ---
+
+// Steady-state peak output of a second-order filter for a unit sine at freq
+static float measure_filter2_gain(vortex::Filter2& f, vortex::Filter2Type type, float freq)
+{
+    float peak = 0.0f;
+    for (int i = 0; i < 48000; i++) {
+        float y = vortex::filter2_process(f, sinf(2.0f * vortex::PI * freq * (float)i / 48000.0f), type);
+        if (i > 24000 && fabsf(y) > peak)
+            peak = fabsf(y);
+    }
+    return peak;
+}
+
+TEST(filter1_shelves)
+{
+    // Low shelf x2: DC doubled. High shelf x2: DC untouched, top doubled.
+    vortex::Filter1 lo, hi;
+    vortex::filter1_configure_low_shelf(lo, 48000.0f, 500.0f, 2.0f);
+    vortex::filter1_configure_high_shelf(hi, 48000.0f, 500.0f, 2.0f);
+    float ylo = 0.0f, yhi = 0.0f;
+    for (int i = 0; i < 4800; i++) {
+        ylo = lo.process_shelf(1.0f);
+        yhi = hi.process_shelf(1.0f);
+    }
+    ASSERT_NEAR(ylo, 2.0f, 0.001f);
+    ASSERT_NEAR(yhi, 1.0f, 0.001f);
+    float peak = 0.0f;
+    for (int i = 0; i < 4800; i++) {
+        float y = hi.process_shelf(i & 1 ? -1.0f : 1.0f);   // Nyquist
+        if (i > 4320 && fabsf(y) > peak) peak = fabsf(y);
+    }
+    ASSERT_NEAR(peak, 2.0f, 0.01f);
+}
+
+TEST(filter2_shelf_and_peak_gains)
+{
+    // +12 dB sections: full gain on their side, unity on the other, half
+    // the gain in dB at the shelf frequency
+    float g = 3.981072f;
+    vortex::Filter2 lo, hi, pk;
+    vortex::filter2_configure_eq(lo, 48000.0f, 1000.0f, 0.707f, g, vortex::F2_LOW_SHELF);
+    vortex::filter2_configure_eq(hi, 48000.0f, 1000.0f, 0.707f, g, vortex::F2_HIGH_SHELF);
+    vortex::filter2_configure_eq(pk, 48000.0f, 1000.0f, 0.5f, g, vortex::F2_PEAK);
+    ASSERT_NEAR(measure_filter2_gain(lo, vortex::F2_LOW_SHELF, 30.0f), g, 0.02f);
+    ASSERT_NEAR(measure_filter2_gain(lo, vortex::F2_LOW_SHELF, 15000.0f), 1.0f, 0.01f);
+    ASSERT_NEAR(measure_filter2_gain(lo, vortex::F2_LOW_SHELF, 1000.0f), sqrtf(g), 0.05f);
+    ASSERT_NEAR(measure_filter2_gain(hi, vortex::F2_HIGH_SHELF, 30.0f), 1.0f, 0.01f);
+    ASSERT_NEAR(measure_filter2_gain(hi, vortex::F2_HIGH_SHELF, 15000.0f), g, 0.05f);
+    ASSERT_NEAR(measure_filter2_gain(hi, vortex::F2_HIGH_SHELF, 1000.0f), sqrtf(g), 0.05f);
+    ASSERT_NEAR(measure_filter2_gain(pk, vortex::F2_PEAK, 1000.0f), g, 0.02f);
+    ASSERT_NEAR(measure_filter2_gain(pk, vortex::F2_PEAK, 30.0f), 1.0f, 0.01f);
+    ASSERT_NEAR(measure_filter2_gain(pk, vortex::F2_PEAK, 15000.0f), 1.0f, 0.01f);
+}
+
+TEST(filter2_eq_unity_gain_is_flat)
+{
+    vortex::Filter2Type types[] = { vortex::F2_LOW_SHELF, vortex::F2_HIGH_SHELF, vortex::F2_PEAK };
+    float in[256];
+    fill_noise(in, 256, 41);
+    for (int t = 0; t < 3; t++) {
+        vortex::Filter2 f;
+        vortex::filter2_configure_eq(f, 48000.0f, 700.0f, 0.3f, 1.0f, types[t]);
+        for (int i = 0; i < 256; i++)
+            ASSERT(vortex::filter2_process(f, in[i], types[t]) == in[i]);
+    }
+}
+
+TEST(filter2_peak_boost_and_cut_mirror)
+{
+    // A cut of 1/g undoes a boost of g at every frequency
+    float freqs[] = { 100.0f, 700.0f, 1000.0f, 1400.0f, 7000.0f };
+    for (int k = 0; k < 5; k++) {
+        vortex::Filter2 boost, cut;
+        vortex::filter2_configure_eq(boost, 48000.0f, 1000.0f, 0.2f, 4.0f, vortex::F2_PEAK);
+        vortex::filter2_configure_eq(cut, 48000.0f, 1000.0f, 0.2f, 0.25f, vortex::F2_PEAK);
+        float b = measure_filter2_gain(boost, vortex::F2_PEAK, freqs[k]);
+        float c = measure_filter2_gain(cut, vortex::F2_PEAK, freqs[k]);
+        ASSERT_NEAR(b * c, 1.0f, 0.01f);
+    }
+}
+
+static void test_eq_layout(vortex::EQLayout& layout, int bands)
+{
+    static const float freq[4] = { 120.0f, 7000.0f, 800.0f, 2500.0f };
+    static const float gain_db[4] = { 6.0f, -9.0f, -12.0f, 4.0f };
+    vortex::eq_layout(layout, bands, freq, gain_db);
+}
+
+TEST(eq_bank_matches_series_filter2)
+{
+    for (int bands = 3; bands <= 4; bands++) {
+        vortex::EQLayout layout;
+        test_eq_layout(layout, bands);
+        vortex::EQBank eq, block;
+        vortex::eq_bank_configure(eq, 48000.0f, 0.707f, layout);
+        vortex::eq_bank_configure(block, 48000.0f, 0.707f, layout);
+        vortex::Filter2 f[4];
+        for (int i = 0; i < bands; i++)
+            vortex::filter2_configure_eq(f[i], 48000.0f, layout.freq[i], layout.width[i],
+                                         layout.gain[i], layout.type[i]);
+
+        float in[256], out[256];
+        fill_noise(in, 256, 43);
+        block.process_block(in, out, 256);
+        for (int n = 0; n < 256; n++) {
+            float ref = in[n];
+            for (int i = 0; i < bands; i++)
+                ref = vortex::filter2_process(f[i], ref, layout.type[i]);
+            ASSERT_NEAR(eq.process(in[n]), ref, 1e-5f);
+            ASSERT_NEAR(out[n], ref, 1e-5f);
+        }
+    }
+}
+
+TEST(eq_bank_updates_only_changed_bands)
+{
+    vortex::EQLayout layout;
+    test_eq_layout(layout, 4);
+    vortex::EQBank eq;
+    ASSERT(vortex::eq_bank_configure(eq, 48000.0f, 0.707f, layout));
+    ASSERT(!vortex::eq_bank_configure(eq, 48000.0f, 0.707f, layout));
+
+    // Mark two bands, then change only band 2's gain
+    eq.b0[1] = -1.0f;
+    eq.b0[2] = -1.0f;
+    layout.gain[2] = 2.0f;
+    ASSERT(vortex::eq_bank_configure(eq, 48000.0f, 0.707f, layout));
+    ASSERT(eq.b0[1] == -1.0f);
+    ASSERT(eq.b0[2] > 0.0f);
+}
+
+TEST(eq_mode_applies_layout)
+{
+    // Flat by default; a +6 dB mid band lifts its centre and nothing far off
+    vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_EQ);
+    xf.reset();
+    vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+    ASSERT_NEAR(measure_mode_gain(xf, 1000.0f), 1.0f, 0.001f);
+
+    static const float freq[4] = { 100.0f, 8000.0f, 1000.0f, 3000.0f };
+    static const float gain_db[4] = { 0.0f, 0.0f, 6.0f, 0.0f };
+    vortex::eq_layout(xf.eq, 3, freq, gain_db);
+    vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+    ASSERT_NEAR(measure_mode_gain(xf, 1000.0f), 1.995f, 0.02f);
+    ASSERT_NEAR(measure_mode_gain(xf, 20.0f), 1.0f, 0.01f);
+}
+
+// --- Mode switching tests ---
+
+TEST(quantize_hysteresis_matches_truncation)
+{
+    // From far away, the quantizer lands on the same step as (int)x
+    ASSERT(vortex::quantize_hysteresis(2.5f, -5, 0.25f) == 2);
+    ASSERT(vortex::quantize_hysteresis(-2.5f, 5, 0.25f) == -2);
+    ASSERT(vortex::quantize_hysteresis(0.9f, -5, 0.25f) == 0);
+    ASSERT(vortex::quantize_hysteresis(-0.9f, 5, 0.25f) == 0);
+}
+
+TEST(quantize_hysteresis_holds_near_edge)
+{
+    // Step 1 spans [1, 2): held just outside its edges, released beyond them
+    ASSERT(vortex::quantize_hysteresis(0.9f, 1, 0.25f) == 1);
+    ASSERT(vortex::quantize_hysteresis(2.1f, 1, 0.25f) == 1);
+    ASSERT(vortex::quantize_hysteresis(0.7f, 1, 0.25f) == 0);
+    ASSERT(vortex::quantize_hysteresis(2.3f, 1, 0.25f) == 2);
+    // Step -1 spans (-2, -1]
+    ASSERT(vortex::quantize_hysteresis(-0.9f, -1, 0.25f) == -1);
+    ASSERT(vortex::quantize_hysteresis(-0.7f, -1, 0.25f) == 0);
+}
+
+TEST(quantize_hysteresis_rejects_boundary_noise)
+{
+    // Noise of +/-0.1 around a step boundary must not flip the step
+    int q = 0;
+    for (int i = 0; i < 100; i++) {
+        float x = 1.0f + ((i & 1) ? 0.1f : -0.1f);
+        int next = vortex::quantize_hysteresis(x, q, 0.25f);
+        ASSERT(next == q);
+    }
+}
+
+TEST(mode_filter_matches_filter2)
+{
+    // A single-stage mode is exactly one configured Filter2
+    vortex::ModeFilter m;
+    vortex::Filter2 f;
+    vortex::mode_filter_configure(m, 48000.0f, 1000.0f, 0.3f, vortex::MODE_BP);
+    vortex::filter2_configure(f, 48000.0f, 1000.0f, 0.3f, vortex::F2_BP);
+    for (int i = 0; i < 480; i++) {
+        float in = sinf(2.0f * vortex::PI * 440.0f * (float)i / 48000.0f);
+        ASSERT(m.process(vortex::MODE_BP, in) == vortex::filter2_process(f, in, vortex::F2_BP));
+    }
+}
+
+TEST(mode_filter_flushes_only_its_mode)
+{
+    // A flush touches the state of the mode's own filters only
+    vortex::ModeFilter m;
+    m.f2a.z0 = 1e-40f;
+    m.bands.num = 1;
+    m.bands.z0[0] = 1e-40f;
+    m.ladder.s[0] = 1e-40f;
+    m.eq.z0[0] = 1e-40f;
+    m.flush_denormals(vortex::MODE_LP12);
+    ASSERT(m.f2a.z0 == 0.0f);
+    ASSERT(m.bands.z0[0] == 1e-40f && m.ladder.s[0] == 1e-40f);
+    ASSERT(m.eq.z0[0] == 1e-40f);
+    m.flush_denormals(vortex::MODE_EQ);
+    ASSERT(m.eq.z0[0] == 0.0f);
+    m.flush_denormals(vortex::MODE_FORMANT);
+    ASSERT(m.bands.z0[0] == 0.0f && m.ladder.s[0] == 1e-40f);
+}
+
+TEST(mode_crossfade_preserves_state)
+{
+    // LP12 -> HP12 keeps the shared second-order state, so once the fade is
+    // over the output matches an HP12 that had been running all along
+    float fs = 48000.0f;
+    vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_LP12);
+    vortex::ModeFilter ref;
+    float out = 0.0f, expect = 0.0f;
+    for (int i = 0; i < 2000; i++) {
+        if (i == 1000)
+            xf.set_mode(vortex::MODE_HP12);
+        float in = sinf(2.0f * vortex::PI * 300.0f * (float)i / fs);
+        vortex::mode_crossfader_configure(xf, fs, 1000.0f, 0.5f);
+        vortex::mode_filter_configure(ref, fs, 1000.0f, 0.5f, vortex::MODE_HP12);
+        out = xf.process(in);
+        expect = ref.process(vortex::MODE_HP12, in);
+    }
+    ASSERT(xf.mode == vortex::MODE_HP12);
+    ASSERT(xf.fade == 0);
+    ASSERT_NEAR(out, expect, 1e-6f);
+}
+
+TEST(mode_crossfade_no_click)
+{
+    // Switching LP24 -> HP6 mid-signal must not jump like a state reset would
+    float fs = 48000.0f;
+    vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_LP24);
+    float prev = 0.0f, maxStep = 0.0f, maxStepBefore = 0.0f;
+    for (int i = 0; i < 4800; i++) {
+        if (i == 2400)
+            xf.set_mode(vortex::MODE_HP6);
+        float in = sinf(2.0f * vortex::PI * 200.0f * (float)i / fs);
+        vortex::mode_crossfader_configure(xf, fs, 2000.0f, 0.707f);
+        float out = xf.process(in);
+        float d = fabsf(out - prev);
+        if (i > 100 && i < 2400 && d > maxStepBefore) maxStepBefore = d;
+        if (i >= 2400 && d > maxStep) maxStep = d;
+        prev = out;
+    }
+    // Sample-to-sample steps stay on the order of the signal's own slope
+    ASSERT(maxStep < maxStepBefore * 3.0f);
+}
+
+TEST(mode_crossfade_defers_mid_fade)
+{
+    // A request during a fade is applied after the fade completes
+    vortex::ModeCrossfader xf;
+    xf.set_mode(vortex::MODE_BP);
+    vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+    ASSERT(xf.mode == vortex::MODE_BP);
+    xf.set_mode(vortex::MODE_AP2);
+    for (int i = 0; i < vortex::MODE_XFADE_SAMPLES; i++) {
+        if (i > 0)
+            vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+        ASSERT(xf.mode == vortex::MODE_BP);
+        xf.process(0.0f);
+    }
+    vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+    ASSERT(xf.mode == vortex::MODE_AP2);
+    ASSERT(xf.prev == vortex::MODE_BP);
+}
+
+// --- Block processing tests ---
+
+TEST(filter1_block_matches_per_sample)
+{
+    float in[256], out[256];
+    fill_noise(in, 256, 7);
+    vortex::Filter1 a, b;
+    vortex::filter1_configure_lp(a, 48000.0f, 500.0f);
+    b = a;
+    a.process_lp_block(in, out, 256);
+    for (int i = 0; i < 256; i++)
+        ASSERT(out[i] == b.process_lp(in[i]));
+    vortex::filter1_configure_hp(a, 48000.0f, 500.0f);
+    b = a;
+    a.process_hp_block(in, out, 256);
+    for (int i = 0; i < 256; i++)
+        ASSERT(out[i] == b.process_hp(in[i]));
+}
+
+TEST(filter2_block_matches_per_sample)
+{
+    float in[256], out[256];
+    fill_noise(in, 256, 11);
+    vortex::Filter2Type types[] = { vortex::F2_LP, vortex::F2_HP, vortex::F2_BP,
+                                    vortex::F2_NOTCH, vortex::F2_AP };
+    for (int t = 0; t < 5; t++) {
+        vortex::Filter2 a, b;
+        vortex::filter2_configure(a, 48000.0f, 700.0f, 0.1f, types[t]);
+        b = a;
+        vortex::filter2_process_block(a, in, out, 256, types[t]);
+        for (int i = 0; i < 256; i++)
+            ASSERT(out[i] == vortex::filter2_process(b, in[i], types[t]));
+        ASSERT(a.z0 == b.z0 && a.z1 == b.z1);
+    }
+}
+
+TEST(filter_block_per_sample_coeffs)
+{
+    // Per-sample coefficient arrays match configuring before every sample
+    float in[128], out[128];
+    fill_noise(in, 128, 3);
+    vortex::Filter1Coeffs c1[128];
+    vortex::Filter2Coeffs c2[128];
+    for (int i = 0; i < 128; i++) {
+        float fc = 100.0f * (float)(i + 1);
+        vortex::filter1_configure_lp(c1[i], 48000.0f, fc);
+        vortex::filter2_configure(c2[i], 48000.0f, fc, 0.3f, vortex::F2_BP);
+    }
+    vortex::Filter1 a1, b1;
+    a1.process_lp_block(in, out, 128, c1);
+    for (int i = 0; i < 128; i++) {
+        vortex::filter1_configure_lp(b1, 48000.0f, 100.0f * (float)(i + 1));
+        ASSERT(out[i] == b1.process_lp(in[i]));
+    }
+    vortex::Filter2 a2, b2;
+    vortex::filter2_process_block(a2, in, out, 128, c2, vortex::F2_BP);
+    for (int i = 0; i < 128; i++) {
+        vortex::filter2_configure(b2, 48000.0f, 100.0f * (float)(i + 1), 0.3f, vortex::F2_BP);
+        ASSERT(out[i] == b2.process_hb(in[i]));
+    }
+}
+
+TEST(mode_filter_block_matches_per_sample)
+{
+    float in[200], out[200];
+    fill_noise(in, 200, 9);
+    for (int mode = 0; mode < vortex::NUM_MODES; mode++) {
+        vortex::ModeFilter a, b;
+        vortex::mode_filter_configure(a, 48000.0f, 1500.0f, 0.2f, mode);
+        vortex::mode_filter_configure(b, 48000.0f, 1500.0f, 0.2f, mode);
+        a.process_block(mode, in, out, 200);
+        for (int i = 0; i < 200; i++)
+            ASSERT_NEAR(out[i], b.process(mode, in[i]), 1e-6f);
+    }
+}
+
+TEST(drive_filter_mix_block_in_place)
+{
+    // Fused kernel matches the per-sample chain, even when in == out
+    float buf[100], in[100];
+    fill_noise(in, 100, 13);
+    for (int i = 0; i < 100; i++) buf[i] = in[i];
+    vortex::ModeCrossfader xf, ref;
+    xf.set_mode(vortex::MODE_LP24);
+    ref.set_mode(vortex::MODE_LP24);
+    vortex::mode_crossfader_configure(xf, 48000.0f, 2000.0f, 0.4f);
+    vortex::drive_filter_mix_block(xf, buf, buf, 100, 0.5f, 0.75f, true);
+    for (int i = 0; i < 100; i++) {
+        vortex::mode_crossfader_configure(ref, 48000.0f, 2000.0f, 0.4f);
+        float wet = ref.process(vortex::soft_clip(in[i] * 5.5f));
+        ref.flush_denormals();
+        ASSERT_NEAR(buf[i], in[i] * 0.25f + wet * 0.75f, 1e-6f);
+    }
+}
+
+TEST(drive_filter_mix_block_adds_and_silence)
+{
+    // NULL input is silence; replace = false accumulates into out
+    float out[64];
+    for (int i = 0; i < 64; i++) out[i] = 1.0f;
+    vortex::ModeCrossfader xf;
+    vortex::mode_crossfader_configure(xf, 48000.0f, 1000.0f, 0.707f);
+    vortex::drive_filter_mix_block(xf, NULL, out, 64, 0.0f, 1.0f, false);
+    for (int i = 0; i < 64; i++)
+        ASSERT(out[i] == 1.0f);
+}
+
+// --- Filter chain tests ---
+
+TEST(chain_single_slot_matches_crossfader)
+{
+    float in[256];
+    fill_noise(in, 256, 17);
+    vortex::FilterChain chain;
+    vortex::ModeCrossfader xf;
+    chain.slot[0].set_mode(vortex::MODE_BP2);
+    xf.set_mode(vortex::MODE_BP2);
+    chain.routing = vortex::CHAIN_PARALLEL;
+    for (int i = 0; i < 256; i++) {
+        float fc = 200.0f + 10.0f * (float)i;
+        vortex::filter_chain_configure(chain, 48000.0f, fc, 0.2f);
+        vortex::mode_crossfader_configure(xf, 48000.0f, fc, 0.2f);
+        ASSERT(chain.process(in[i]) == xf.process(in[i]));
+    }
+}
+
+TEST(chain_series_matches_separate_filters)
+{
+    // LP12 into HP12 an octave below: same as two crossfaders in a row
+    float in[256];
+    fill_noise(in, 256, 19);
+    vortex::FilterChain chain;
+    chain.slot[0].set_mode(vortex::MODE_LP12);
+    chain.slot[1].set_mode(vortex::MODE_HP12);
+    chain.ratio[1] = 0.5f;
+    chain.set_slots(2);
+    vortex::ModeCrossfader a, b;
+    a.set_mode(vortex::MODE_LP12);
+    b.set_mode(vortex::MODE_HP12);
+    b.reset();
+    vortex::filter_chain_configure(chain, 48000.0f, 2000.0f, 0.3f);
+    vortex::mode_crossfader_configure(a, 48000.0f, 2000.0f, 0.3f);
+    vortex::mode_crossfader_configure(b, 48000.0f, 1000.0f, 0.3f);
+    for (int i = 0; i < 256; i++)
+        ASSERT(chain.process(in[i]) == b.process(a.process(in[i])));
+}
+
+TEST(chain_parallel_averages_slots)
+{
+    float in[256];
+    fill_noise(in, 256, 23);
+    vortex::FilterChain chain;
+    chain.routing = vortex::CHAIN_PARALLEL;
+    chain.slot[0].set_mode(vortex::MODE_BP);
+    chain.slot[0].reset();
+    chain.slot[1].set_mode(vortex::MODE_BP);
+    chain.ratio[1] = 4.0f;
+    chain.set_slots(2);
+    vortex::ModeCrossfader a, b;
+    a.set_mode(vortex::MODE_BP);
+    b.set_mode(vortex::MODE_BP);
+    a.reset();
+    b.reset();
+    vortex::filter_chain_configure(chain, 48000.0f, 500.0f, 0.1f);
+    vortex::mode_crossfader_configure(a, 48000.0f, 500.0f, 0.1f);
+    vortex::mode_crossfader_configure(b, 48000.0f, 2000.0f, 0.1f);
+    for (int i = 0; i < 256; i++)
+        ASSERT_NEAR(chain.process(in[i]), 0.5f * (a.process(in[i]) + b.process(in[i])), 1e-6f);
+}
+
+TEST(chain_block_matches_per_sample)
+{
+    // Mixed modes; in-place blocks longer than a chunk
+    float in[300], buf[300];
+    fill_noise(in, 300, 29);
+    for (int r = 0; r < vortex::NUM_CHAIN_ROUTINGS; r++) {
+        vortex::FilterChain a, b;
+        int modes[3] = { vortex::MODE_LP24, vortex::MODE_BP, vortex::MODE_LADDER };
+        for (int s = 0; s < 3; s++) {
+            a.slot[s].set_mode(modes[s]);
+            b.slot[s].set_mode(modes[s]);
+            a.ratio[s] = b.ratio[s] = 1.0f + (float)s;
+        }
+        a.routing = b.routing = r;
+        a.set_slots(3);
+        b.set_slots(3);
+        vortex::filter_chain_configure(a, 48000.0f, 800.0f, 0.3f);
+        vortex::filter_chain_configure(b, 48000.0f, 800.0f, 0.3f);
+        for (int i = 0; i < 300; i++) buf[i] = in[i];
+        a.process_block(buf, buf, 300);
+        for (int i = 0; i < 300; i++)
+            ASSERT_NEAR(buf[i], b.process(in[i]), 1e-6f);
+    }
+}
+
+TEST(chain_new_slot_starts_silent)
+{
+    vortex::FilterChain chain;
+    chain.set_slots(2);
+    vortex::filter_chain_configure(chain, 48000.0f, 1000.0f, 0.5f);
+    for (int i = 0; i < 100; i++)
+        chain.process(1.0f);
+    chain.set_slots(1);
+    chain.slot[1].set_mode(vortex::MODE_HP12);
+    chain.set_slots(2);
+    const vortex::ModeFilter& m = chain.slot[1].bank[chain.slot[1].cur];
+    ASSERT(m.f2a.z0 == 0.0f && m.f2a.z1 == 0.0f);
+    // ... in its new mode, without a fade
+    ASSERT(chain.slot[1].mode == vortex::MODE_HP12 && chain.slot[1].fade == 0);
+}
+
+TEST(chain_recovers_from_nan)
+{
+    // A NaN input sample clears the state it reaches instead of latching
+    for (int mode = 0; mode < vortex::NUM_MODES; mode++) {
+        vortex::FilterChain chain;
+        chain.slot[0].set_mode(mode);
+        chain.slot[0].reset();
+        vortex::filter_chain_configure(chain, 48000.0f, 1000.0f, 0.2f);
+        float y = 0.0f;
+        for (int i = 0; i < 200; i++) {
+            y = chain.process(i == 10 ? NAN : 0.1f);
+            chain.flush_denormals();
+        }
+        ASSERT(y == y);
+    }
+}
+
+// --- Cutoff FM tests ---
+
+TEST(fm_linear_deviates_in_hz)
+{
+    ASSERT(vortex::fm_linear(1000.0f, 0.0f) == 1000.0f);
+    ASSERT(vortex::fm_linear(1000.0f, 0.5f) == 1500.0f);
+    ASSERT(vortex::fm_linear(1000.0f, -2.0f) == -1000.0f);
+}
+
+TEST(thru_zero_reflects_cutoff)
+{
+    // A negative cutoff runs as its reflection, band-pass modes inverted
+    float in[256];
+    fill_noise(in, 256, 31);
+    for (int mode = 0; mode < vortex::NUM_MODES; mode++) {
+        vortex::FilterChain neg, pos;
+        neg.slot[0].set_mode(mode);
+        pos.slot[0].set_mode(mode);
+        neg.slot[0].reset();
+        pos.slot[0].reset();
+        vortex::filter_chain_configure(neg, 48000.0f, -1500.0f, 0.2f);
+        vortex::filter_chain_configure(pos, 48000.0f, 1500.0f, 0.2f);
+        float sign = vortex::mode_thru_zero_sign(mode);
+        for (int i = 0; i < 256; i++)
+            ASSERT(neg.process(in[i]) == sign * pos.process(in[i]));
+    }
+    ASSERT(vortex::mode_thru_zero_sign(vortex::MODE_BP) < 0.0f);
+    ASSERT(vortex::mode_thru_zero_sign(vortex::MODE_BP2) > 0.0f);
+}
+
+// Runs a chain under audio-rate FM (3 kHz modulator, depth x 5V), with the
+// cutoff and coefficients updated every sample as step() does: half a
+// second of noise, then half a second of silence with the FM still running.
+// Returns the peak output, and in tail the peak of the last 10ms.
+static float fm_run(int mode, int fm_mode, float depth, float damping, float& tail)
+{
+    static float in[48000];
+    fill_noise(in, 24000, 37);
+    vortex::FilterChain chain;
+    chain.slot[0].set_mode(mode);
+    chain.slot[0].reset();
+    float peak = 0.0f;
+    tail = 0.0f;
+    for (int i = 0; i < 48000; i++) {
+        float fm = depth * 5.0f * sinf(2.0f * vortex::PI * 3000.0f * (float)i / 48000.0f);
+        float fc = fm_mode == vortex::FM_EXP
+                 ? 1000.0f * vortex::voct_to_mult(fm)
+                 : vortex::fm_linear(1000.0f, fm);
+        if (fc < 20.0f && fm_mode != vortex::FM_THRU_ZERO) fc = 20.0f;
+        if (fc > 20000.0f) fc = 20000.0f;
+        vortex::filter_chain_configure(chain, 48000.0f, fc, damping);
+        float y = fabsf(chain.process(i < 24000 ? in[i] * 0.5f : 0.0f));
+        chain.flush_denormals();
+        if (!(y <= peak))
+            peak = y;   // (NaN sticks)
+        if (i >= 47520 && !(y <= tail))
+            tail = y;
+    }
+    return peak;
+}
+
+TEST(fm_extreme_depth_stable)
+{
+    // Full depth both ways, from Butterworth to near self-oscillation: the
+    // output stays within the resonant gain and dies away after the input
+    // stops (the ladder self-oscillates near zero damping, so only bounded)
+    float depths[] = { 1.0f, -1.0f };
+    float dampings[] = { 0.707f, 0.01f };
+    for (int mode = 0; mode < vortex::NUM_MODES; mode++)
+        for (int fm = 0; fm < vortex::NUM_FM_MODES; fm++)
+            for (int d = 0; d < 2; d++)
+                for (int r = 0; r < 2; r++) {
+                    float tail;
+                    float peak = fm_run(mode, fm, depths[d], dampings[r], tail);
+                    ASSERT(peak == peak && peak < 2500.0f);
+                    if (mode != vortex::MODE_LADDER || r == 0)
+                        ASSERT(tail < 1e-3f);
+                }
+}
+
+// --- Modulated processing tests ---
+
+TEST(modulate_cutoff_tracks_and_clamps)
+{
+    float voct[8] = { 0.0f, 1.0f, -1.0f, 10.0f, -10.0f, 2.0f, 0.5f, 0.0f };
+    float fm[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, -5.0f, -5.0f };
+    float c[8];
+    vortex::modulate_cutoff(c, voct, NULL, 1000.0f, 1.0f, vortex::FM_EXP, false, 1, 8);
+    ASSERT_NEAR(c[0], 1000.0f, 1e-3f);
+    ASSERT_NEAR(c[1], 2000.0f, 1e-2f);
+    ASSERT_NEAR(c[2], 500.0f, 1e-2f);
+    ASSERT(c[3] == 20000.0f && c[4] == 20.0f);
+    // Exp FM folds into the octave sum
+    vortex::modulate_cutoff(c, voct, fm, 1000.0f, 1.0f, vortex::FM_EXP, false, 1, 8);
+    ASSERT_NEAR(c[5], 2000.0f, 1e-2f);
+    // Linear FM stops at 20 Hz; through-zero carries on below zero
+    vortex::modulate_cutoff(c, NULL, fm, 1000.0f, 1.0f, vortex::FM_LINEAR, false, 1, 8);
+    ASSERT(c[5] == 20.0f && c[7] == 20.0f);
+    vortex::modulate_cutoff(c, NULL, fm, 1000.0f, 1.0f, vortex::FM_THRU_ZERO, false, 1, 8);
+    ASSERT(c[5] == 0.0f && c[7] == -4000.0f);
+}
+
+TEST(modulate_strides)
+{
+    // Only update points are written
+    float cv[16], c[16], d[16];
+    for (int i = 0; i < 16; i++) { cv[i] = 1.0f; c[i] = d[i] = -1.0f; }
+    vortex::modulate_cutoff(c, cv, NULL, 500.0f, 0.0f, vortex::FM_EXP, true, 4, 16);
+    vortex::modulate_linear(d, cv, 0.5f, -0.2f, 0.01f, 0.707f, 4, 16);
+    for (int i = 0; i < 16; i++) {
+        if (i % 4) {
+            ASSERT(c[i] == -1.0f && d[i] == -1.0f);
+        } else {
+            ASSERT_NEAR(c[i], 1000.0f, 0.2f);
+            ASSERT_NEAR(d[i], 0.3f, 1e-6f);
+        }
+    }
+    // Unpatched: the base value, unclamped
+    vortex::modulate_linear(d, NULL, 2.0f, 0.2f, 0.0f, 1.0f, 1, 16);
+    ASSERT(d[0] == 2.0f && d[15] == 2.0f);
+}
+
+TEST(drive_filter_mix_controls_matches_per_sample)
+{
+    // Same as configuring and running the chain sample by sample
+    float in[32], buf[32], drive[32], mix[32];
+    fill_noise(in, 32, 41);
+    fill_noise(drive, 32, 43);
+    fill_noise(mix, 32, 47);
+    vortex::ControlBlock ctl;
+    for (int i = 0; i < 32; i++) {
+        buf[i] = in[i];
+        ctl.cutoff[i] = 300.0f + 50.0f * (float)i;
+        ctl.damping[i] = 0.05f + 0.01f * (float)i;
+        ctl.drive[i] = drive[i] > 0.0f ? drive[i] : 0.0f;
+        ctl.mix[i] = 0.5f + 0.5f * mix[i];
+    }
+    for (int mask = 0; mask < 16; mask = mask * 2 + 1) {
+        vortex::FilterChain a, b;
+        a.slot[0].set_mode(vortex::MODE_LP24);
+        b.slot[0].set_mode(vortex::MODE_LP24);
+        for (int i = 0; i < 32; i++) buf[i] = in[i];
+        vortex::drive_filter_mix_controls(a, buf, buf, 32, ctl, mask, 48000.0f, true);
+        for (int i = 0; i < 32; i++) {
+            int u = i & ~mask;
+            vortex::filter_chain_configure(b, 48000.0f, ctl.cutoff[u], ctl.damping[u]);
+            float x = in[i];
+            if (ctl.drive[i] > 0.0f)
+                x = vortex::soft_clip(x * (1.0f + ctl.drive[i] * 9.0f));
+            float wet = b.process(x);
+            b.flush_denormals();
+            ASSERT(buf[i] == in[i] * (1.0f - ctl.mix[i]) + wet * ctl.mix[i]);
+        }
+    }
+}
+
+TEST(drive_filter_mix_controls_range_in_pieces)
+{
+    // A chunk run in uneven pieces matches the chunk run in one go
+    float in[32], whole[32], pieces[32];
+    fill_noise(in, 32, 53);
+    vortex::ControlBlock ctl;
+    for (int i = 0; i < 32; i++) {
+        ctl.cutoff[i] = 2000.0f - 40.0f * (float)i;
+        ctl.damping[i] = 0.3f - 0.005f * (float)i;
+        ctl.drive[i] = 0.02f * (float)i;
+        ctl.mix[i] = 1.0f - 0.01f * (float)i;
+    }
+    static const int cuts[] = { 0, 3, 4, 11, 12, 29, 32 };
+    for (int mask = 0; mask < 16; mask = mask * 2 + 1) {
+        vortex::FilterChain a, b;
+        a.slot[0].set_mode(vortex::MODE_BP2);
+        b.slot[0].set_mode(vortex::MODE_BP2);
+        vortex::drive_filter_mix_controls(a, in, whole, 32, ctl, mask, 48000.0f, true);
+        for (int c = 0; c + 1 < 7; c++)
+            vortex::drive_filter_mix_controls_range(b, in, pieces, cuts[c], cuts[c + 1],
+                                                    ctl, mask, 48000.0f, true);
+        for (int i = 0; i < 32; i++)
+            ASSERT(pieces[i] == whole[i]);
+    }
+}
+
+// --- Modulation source tests ---
+
+TEST(lfo_shapes)
+{
+    vortex::LFO lfo;
+    static const float phases[3] = { 0.25f, 0.5f, 0.75f };
+    static const float expect[vortex::NUM_LFO_SHAPES - 1][3] = {
+        { 1.0f, 0.0f, -1.0f },      // sine
+        { 0.0f, 1.0f, 0.0f },       // triangle
+        { -0.5f, 0.0f, 0.5f },      // saw
+        { 1.0f, -1.0f, -1.0f },     // square
+    };
+    for (int s = 0; s < vortex::NUM_LFO_SHAPES - 1; s++) {
+        lfo.shape = s;
+        for (int i = 0; i < 3; i++) {
+            lfo.phase = phases[i];
+            ASSERT_NEAR(vortex::lfo_advance(lfo, 0), expect[s][i], 1e-6f);
+        }
+    }
+}
+
+TEST(lfo_rate_and_random_hold)
+{
+    // A 2 Hz LFO stepped a chunk at a time is half way through its third
+    // cycle after 1.25 seconds, and S&H has picked a new level per cycle
+    vortex::LFO lfo;
+    lfo.shape = vortex::LFO_RANDOM;
+    vortex::lfo_configure(lfo, 2.0f, 48000.0f);
+    float last = vortex::lfo_advance(lfo, 0);
+    int changes = 0;
+    for (int i = 0; i < 60000 / 32; i++) {
+        float v = vortex::lfo_advance(lfo, 32);
+        ASSERT(v >= -1.0f && v <= 1.0f);
+        if (v != last) changes++;
+        last = v;
+    }
+    ASSERT_NEAR(lfo.phase, 0.5f, 1e-3f);
+    ASSERT(changes == 2);
+}
+
+TEST(envelope_attack_and_release)
+{
+    // 5V in: one time constant of attack reaches 1 - 1/e, independent of
+    // the chunk size; then one of release decays by 1/e
+    static float in[480];
+    for (int i = 0; i < 480; i++) in[i] = (i & 1) ? 5.0f : -5.0f;
+    vortex::EnvelopeFollower a, b;
+    vortex::envelope_configure(a, 10.0f, 100.0f, 48000.0f);
+    vortex::envelope_configure(b, 10.0f, 100.0f, 48000.0f);
+    for (int i = 0; i < 480; i += 32) vortex::envelope_process(a, in + i, 32);
+    for (int i = 0; i < 480; i += 16) vortex::envelope_process(b, in + i, 16);
+    ASSERT_NEAR(a.env, 1.0f - expf(-1.0f), 1e-4f);
+    ASSERT_NEAR(b.env, a.env, 1e-5f);
+    float peak = a.env;
+    for (int i = 0; i < 4800; i += 32) vortex::envelope_process(a, NULL, 32);
+    ASSERT_NEAR(a.env, peak * expf(-1.0f), 1e-4f);
+    // NaN is ignored, Inf reads as full level
+    float bad[2] = { NAN, 0.0f };
+    vortex::envelope_process(a, bad, 2);
+    ASSERT(a.env >= 0.0f && a.env < peak);
+    bad[0] = INFINITY;
+    vortex::envelope_configure(a, 0.001f, 100.0f, 48000.0f);
+    ASSERT_NEAR(vortex::envelope_process(a, bad, 2), 1.0f, 1e-6f);
+}
+
+TEST(mod_matrix_zero_depth_is_inactive)
+{
+    vortex::ModMatrix m;
+    ASSERT(!vortex::mod_matrix_active(m));
+    vortex::lfo_configure(m.lfo, 5.0f, 48000.0f);
+    float cutoff = 1000.0f, damping = 0.3f, mix = 0.5f;
+    vortex::mod_matrix_apply(m, NULL, 32, cutoff, damping, mix);
+    ASSERT(cutoff == 1000.0f && damping == 0.3f && mix == 0.5f);
+    m.depth[vortex::MOD_ENV][vortex::MOD_MIX] = 0.1f;
+    ASSERT(vortex::mod_matrix_active(m));
+}
+
+TEST(mod_matrix_applies_depths)
+{
+    // Square LFO at +1: 20% depth is an octave up, like a 1V CV
+    vortex::ModMatrix m;
+    m.lfo.shape = vortex::LFO_SQUARE;
+    m.depth[vortex::MOD_LFO][vortex::MOD_CUTOFF] = 0.2f;
+    m.depth[vortex::MOD_LFO][vortex::MOD_RESONANCE] = 0.1f;
+    m.depth[vortex::MOD_LFO][vortex::MOD_MIX] = -0.25f;
+    float cutoff = 1000.0f, damping = 0.3f, mix = 1.0f;
+    vortex::mod_matrix_apply(m, NULL, 32, cutoff, damping, mix);
+    ASSERT_NEAR(cutoff, 2000.0f, 0.1f);
+    ASSERT_NEAR(damping, 0.2f, 1e-6f);
+    ASSERT_NEAR(mix, 0.75f, 1e-6f);
+
+    // Full depth clamps to the CV ranges
+    m.depth[vortex::MOD_LFO][vortex::MOD_CUTOFF] = 1.0f;
+    m.depth[vortex::MOD_LFO][vortex::MOD_RESONANCE] = 1.0f;
+    m.depth[vortex::MOD_LFO][vortex::MOD_MIX] = 1.0f;
+    cutoff = 1000.0f; damping = 0.3f; mix = 0.5f;
+    vortex::mod_matrix_apply(m, NULL, 32, cutoff, damping, mix);
+    ASSERT(cutoff == 20000.0f && damping == 0.01f && mix == 1.0f);
+
+    // Envelope follower: a settled 5V input at -20% is an octave down
+    vortex::ModMatrix e;
+    vortex::envelope_configure(e.env, 1.0f, 100.0f, 48000.0f);
+    e.depth[vortex::MOD_ENV][vortex::MOD_CUTOFF] = -0.2f;
+    float in[32];
+    for (int i = 0; i < 32; i++) in[i] = 5.0f;
+    for (int k = 0; k < 50; k++) {
+        cutoff = 1000.0f; damping = 0.3f; mix = 1.0f;
+        vortex::mod_matrix_apply(e, in, 32, cutoff, damping, mix);
+    }
+    ASSERT_NEAR(cutoff, 500.0f, 0.1f);
+    ASSERT(damping == 0.3f && mix == 1.0f);
+}
+
+// --- CPU governor tests ---
+
+TEST(fast_exp2_accuracy)
+{
+    for (int i = -800; i <= 800; i++) {
+        float x = (float)i * 0.01f;
+        ASSERT_NEAR(vortex::fast_exp2(x) / powf(2.0f, x), 1.0f, 2e-4f);
+    }
+}
+
+TEST(governor_steps_down_under_load)
+{
+    vortex::Governor g;
+    ASSERT(vortex::governor_update(g, 1200, 1000));
+    ASSERT(g.level == vortex::QUALITY_CV4);
+    vortex::governor_update(g, 1200, 1000);
+    vortex::governor_update(g, 1200, 1000);
+    ASSERT(g.level == vortex::QUALITY_FAST);
+    // Already at the bottom
+    ASSERT(!vortex::governor_update(g, 1200, 1000));
+    ASSERT(g.level == vortex::QUALITY_FAST);
+}
+
+TEST(governor_recovers_with_hysteresis)
+{
+    vortex::Governor g;
+    vortex::governor_update(g, 1200, 1000);
+    // Under budget but above the step-up threshold: stays down
+    for (int i = 0; i < 1000; i++)
+        vortex::governor_update(g, 900, 1000);
+    ASSERT(g.level == vortex::QUALITY_CV4);
+    // Headroom must be sustained; one busy block restarts the count
+    for (int i = 0; i < vortex::GOVERNOR_RECOVER_BLOCKS - 1; i++)
+        vortex::governor_update(g, 500, 1000);
+    vortex::governor_update(g, 700, 1000);
+    for (int i = 0; i < vortex::GOVERNOR_RECOVER_BLOCKS - 1; i++)
+        vortex::governor_update(g, 500, 1000);
+    ASSERT(g.level == vortex::QUALITY_CV4);
+    ASSERT(vortex::governor_update(g, 500, 1000));
+    ASSERT(g.level == vortex::QUALITY_FULL);
+}
+
+TEST(governor_holds_when_nothing_to_reduce)
+{
+    // Over budget on a path the level doesn't change: no step down, and
+    // a level set earlier recovers as if there were headroom
+    vortex::Governor g;
+    ASSERT(!vortex::governor_update(g, 5000, 1000, vortex::QUALITY_FULL));
+    ASSERT(g.level == vortex::QUALITY_FULL);
+    vortex::governor_update(g, 1200, 1000);
+    ASSERT(g.level == vortex::QUALITY_CV4);
+    for (int i = 0; i < vortex::GOVERNOR_RECOVER_BLOCKS - 1; i++)
+        vortex::governor_update(g, 5000, 1000, vortex::QUALITY_FULL);
+    ASSERT(g.level == vortex::QUALITY_CV4);
+    ASSERT(vortex::governor_update(g, 5000, 1000, vortex::QUALITY_FULL));
+    ASSERT(g.level == vortex::QUALITY_FULL);
+}
+
+TEST(governor_skips_fast_without_pitch_cvs)
+{
+    // Fast only saves time on V/OCT and FM: without them the governor
+    // stops at CV/16, and leaves Fast when they are unpatched
+    vortex::Governor g;
+    for (int i = 0; i < 10; i++)
+        vortex::governor_update(g, 5000, 1000, vortex::QUALITY_CV16);
+    ASSERT(g.level == vortex::QUALITY_CV16);
+    vortex::governor_update(g, 5000, 1000);
+    ASSERT(g.level == vortex::QUALITY_FAST);
+    for (int i = 0; i < vortex::GOVERNOR_RECOVER_BLOCKS; i++)
+        vortex::governor_update(g, 5000, 1000, vortex::QUALITY_CV16);
+    ASSERT(g.level == vortex::QUALITY_CV16);
+}
+
+TEST(governor_off_with_zero_budget)
+{
+    vortex::Governor g;
+    vortex::governor_update(g, 1200, 1000);
+    ASSERT(vortex::governor_update(g, 1000000, 0));
+    ASSERT(g.level == vortex::QUALITY_FULL);
+}
+
+TEST(quality_update_interval_levels)
+{
+    ASSERT(vortex::quality_update_interval(vortex::QUALITY_FULL) == 1);
+    ASSERT(vortex::quality_update_interval(vortex::QUALITY_CV4) == 4);
+    ASSERT(vortex::quality_update_interval(vortex::QUALITY_CV16) == 16);
+    ASSERT(vortex::quality_update_interval(vortex::QUALITY_FAST) == 16);
+}
+
+// --- Trace tests ---
+
+static vortex::TraceFrame traceFrames[vortex::TRACE_FRAMES];
+
+static vortex::TraceFrame trace_point(int i)
+{
+    vortex::TraceFrame f;
+    f.cutoff = 100.0f + (float)i;
+    f.damping = 0.5f;
+    f.drive = 0.25f;
+    f.s0 = -1.5f * (float)i;
+    f.s1 = 1e-20f;
+    f.mode = i % vortex::NUM_MODES;
+    return f;
+}
+
+TEST(trace_decimates)
+{
+    vortex::TraceBuffer t;
+    t.frames = traceFrames;
+    t.decimation = 4;
+    int due = 0;
+    for (int i = 0; i < 40; i++)
+        if (vortex::trace_due(t, 1)) due++;
+    ASSERT(due == 10);
+    // Whole blocks count as many samples
+    t.clear();
+    ASSERT(vortex::trace_due(t, 128));
+    t.frozen = true;
+    ASSERT(!vortex::trace_due(t, 128));
+}
+
+TEST(trace_keeps_remainder)
+{
+    // Trace Every 48 in 32-sample chunks: a point every 48 samples, not
+    // every second chunk
+    vortex::TraceBuffer t;
+    t.frames = traceFrames;
+    t.decimation = 48;
+    int due = 0;
+    for (int i = 0; i < 30; i++)
+        if (vortex::trace_due(t, 32)) due++;
+    ASSERT(due == 20);
+    ASSERT(t.phase == 0);
+}
+
+TEST(trace_span_splits_blocks)
+{
+    // Trace Every below the block size: splitting at trace_span() gives
+    // a point at each due sample, carried across blocks
+    vortex::TraceBuffer t;
+    t.frames = traceFrames;
+    t.decimation = 5;
+    int due = 0, ends_on_point = 0;
+    long pos = 0;
+    for (int block = 0; block < 5; block++)
+        for (int i = 0; i < 128; )
+        {
+            int n = vortex::trace_span(t, 128 - i);
+            ASSERT(n >= 1 && n <= 128 - i);
+            i += n;
+            pos += n;
+            if (vortex::trace_due(t, n))
+            {
+                due++;
+                if (pos % 5 == 0) ends_on_point++;
+            }
+        }
+    ASSERT(due == 128);
+    ASSERT(ends_on_point == due);
+    // Frozen: no splitting and no points
+    t.frozen = true;
+    ASSERT(vortex::trace_span(t, 128) == 128);
+    ASSERT(!vortex::trace_due(t, 128));
+}
+
+TEST(trace_ring_keeps_newest)
+{
+    vortex::TraceBuffer t;
+    t.frames = traceFrames;
+    int n = (int)vortex::TRACE_FRAMES + 10;
+    for (int i = 0; i < n; i++)
+        vortex::trace_push(t, trace_point(i));
+    ASSERT(t.count == vortex::TRACE_FRAMES);
+    ASSERT(t.frame(0).cutoff == trace_point(10).cutoff);
+    ASSERT(t.frame(t.count - 1).cutoff == trace_point(n - 1).cutoff);
+}
+
+TEST(trace_sysex_round_trip)
+{
+    vortex::TraceBuffer t;
+    t.frames = traceFrames;
+    t.instance = 5;
+    for (int i = 0; i < 50; i++)
+        vortex::trace_push(t, trace_point(i));
+
+    static uint8_t msg[50 * vortex::TRACE_WORDS * 5 + 16];
+    uint32_t len = vortex::trace_sysex_size(t);
+    for (uint32_t i = 0; i < len; i++) {
+        msg[i] = vortex::trace_sysex_byte(t, i);
+        // Only the framing bytes have the top bit set
+        ASSERT(msg[i] < 0x80 || i == 0 || i == len - 1);
+    }
+    ASSERT(msg[len - 1] == 0xF7);
+
+    vortex::TraceFrame out[50];
+    uint8_t instance = 0;
+    ASSERT(vortex::trace_decode_sysex(msg, len, out, 50, &instance) == 50);
+    ASSERT(instance == 5);
+    for (int i = 0; i < 50; i++) {
+        vortex::TraceFrame f = trace_point(i);
+        ASSERT(out[i].cutoff == f.cutoff && out[i].s0 == f.s0 && out[i].s1 == f.s1);
+        ASSERT(out[i].mode == f.mode && out[i].drive == f.drive);
+    }
+    // Truncated messages are rejected, also when another message follows
+    ASSERT(vortex::trace_decode_sysex(msg, len - 2, out, 50) == 0);
+    msg[len - 40] = 0xF0;
+    ASSERT(vortex::trace_decode_sysex(msg, len, out, 50) == 0);
+}
+
+TEST(trace_request_parser)
+{
+    vortex::TraceRequestParser p;
+    const uint8_t full[] = { 0xF0, 0x7D, 'V', 'T', 0x01, 0xF7 };
+    const uint8_t bare[] = { 0x7D, 'V', 'T', 0x01 };
+    const uint8_t other[] = { 0xF0, 0x00, 0x21, 0x27, 0x01, 0xF7 };
+    bool got = false;
+    for (int i = 0; i < 6; i++)
+        got = vortex::trace_parse_request(p, full[i], i == 5);
+    ASSERT(got);
+    for (int i = 0; i < 4; i++)
+        got = vortex::trace_parse_request(p, bare[i], i == 3);
+    ASSERT(got);
+    for (int i = 0; i < 6; i++)
+        got = vortex::trace_parse_request(p, other[i], i == 5);
+    ASSERT(!got);
+}
+
 int main()
 {
     printf("Vortex DSP Tests\n");
@@ -348,11 +1674,17 @@ int main()
     run_voct_to_mult_one();
     run_flush_denormal_normal();
     run_flush_denormal_zero();
+    run_flush_denormal_non_finite();
     run_cutoff_param_to_hz_min();
     run_cutoff_param_to_hz_mid();
     run_cutoff_param_to_hz_max();
     run_resonance_to_damping_zero();
     run_resonance_to_damping_max();
+    run_cutoff_table_matches_powf();
+    run_cutoff_table_is_constexpr();
+    run_note_table_matches_powf();
+    run_keytrack_mult_full_and_off();
+    run_keytrack_mult_partial();
 
     printf("\nFirst-order filter:\n");
     run_filter1_lp_passes_dc();
@@ -371,6 +1703,94 @@ int main()
     run_filter2_resonance_peak();
     run_filter2_cascade_steeper();
     run_filter2_reset();
+    run_filter2_copy_coefficients_matches_configure();
+    run_filter2_configure_cached_matches_full();
+    run_filter2_configure_cached_skips_unchanged();
+
+    printf("\nLadder filter:\n");
+    run_ladder_passes_dc();
+    run_ladder_attenuates_high_freq();
+    run_ladder_resonance_peak();
+    run_ladder_bounded_when_driven_hard();
+    run_ladder_reset();
+
+    printf("\nBand-pass bank:\n");
+    run_bank_matches_parallel_filter2();
+    run_bank_updates_only_moved_bands();
+    run_bank_skips_bands_past_num();
+    run_bank_mutes_bands_above_nyquist_margin();
+    run_formant_layout_interpolates_vowels();
+    run_formant_mode_peaks_at_first_formant();
+
+    printf("\nShelf / peak EQ:\n");
+    run_filter1_shelves();
+    run_filter2_shelf_and_peak_gains();
+    run_filter2_eq_unity_gain_is_flat();
+    run_filter2_peak_boost_and_cut_mirror();
+    run_eq_bank_matches_series_filter2();
+    run_eq_bank_updates_only_changed_bands();
+    run_eq_mode_applies_layout();
+
+    printf("\nMode switching:\n");
+    run_quantize_hysteresis_matches_truncation();
+    run_quantize_hysteresis_holds_near_edge();
+    run_quantize_hysteresis_rejects_boundary_noise();
+    run_mode_filter_matches_filter2();
+    run_mode_filter_flushes_only_its_mode();
+    run_mode_crossfade_preserves_state();
+    run_mode_crossfade_no_click();
+    run_mode_crossfade_defers_mid_fade();
+
+    printf("\nBlock processing:\n");
+    run_filter1_block_matches_per_sample();
+    run_filter2_block_matches_per_sample();
+    run_filter_block_per_sample_coeffs();
+    run_mode_filter_block_matches_per_sample();
+    run_drive_filter_mix_block_in_place();
+    run_drive_filter_mix_block_adds_and_silence();
+
+    printf("\nFilter chain:\n");
+    run_chain_single_slot_matches_crossfader();
+    run_chain_series_matches_separate_filters();
+    run_chain_parallel_averages_slots();
+    run_chain_block_matches_per_sample();
+    run_chain_new_slot_starts_silent();
+    run_chain_recovers_from_nan();
+
+    printf("\nCutoff FM:\n");
+    run_fm_linear_deviates_in_hz();
+    run_thru_zero_reflects_cutoff();
+    run_fm_extreme_depth_stable();
+
+    printf("\nModulated processing:\n");
+    run_modulate_cutoff_tracks_and_clamps();
+    run_modulate_strides();
+    run_drive_filter_mix_controls_matches_per_sample();
+    run_drive_filter_mix_controls_range_in_pieces();
+
+    printf("\nModulation sources:\n");
+    run_lfo_shapes();
+    run_lfo_rate_and_random_hold();
+    run_envelope_attack_and_release();
+    run_mod_matrix_zero_depth_is_inactive();
+    run_mod_matrix_applies_depths();
+
+    printf("\nCPU governor:\n");
+    run_fast_exp2_accuracy();
+    run_governor_steps_down_under_load();
+    run_governor_recovers_with_hysteresis();
+    run_governor_holds_when_nothing_to_reduce();
+    run_governor_skips_fast_without_pitch_cvs();
+    run_governor_off_with_zero_budget();
+    run_quality_update_interval_levels();
+
+    printf("\nTrace:\n");
+    run_trace_decimates();
+    run_trace_keeps_remainder();
+    run_trace_span_splits_blocks();
+    run_trace_ring_keeps_newest();
+    run_trace_sysex_round_trip();
+    run_trace_request_parser();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return (tests_passed == tests_run) ? 0 : 1;
@@ -0,0 +1,448 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../dsp.h"
+#include "reference.h"
+
+// Accuracy harness: runs every candidate float path of the Vortex chain
+// against the double-precision reference model (reference.h) for every mode
+// and reports error in dB relative to the reference output level:
+//
+//   max  = 20*log10(max |candidate - reference| / rms(reference))
+//   rms  = 20*log10(rms(candidate - reference)  / rms(reference))
+//   fr   = worst magnitude-response deviation in dB over a set of sine
+//          frequencies and, in the bank modes, every band centre
+//          (ignoring points more than 80 dB down)
+//
+// Each candidate has its own limits per mode, one set for the fixed-cutoff
+// signals and the response and one for the swept cutoff. Any breach fails
+// the run, so speed work on a kernel can't silently change the sound.
+
+static const float kSampleRate = 48000.0f;
+static const int kFrames = 24000;
+static const float kDamping = 0.3f;
+static const float kDrive = 0.25f;
+static const float kMix = 0.8f;
+
+// EQ mode runs this 4-band layout rather than the crossfader's flat default
+static vortex::EQLayout test_eq_layout()
+{
+    static const float freq[vortex::EQ_MAX_BANDS] = { 150.0f, 6000.0f, 900.0f, 2500.0f };
+    static const float gain_db[vortex::EQ_MAX_BANDS] = { 9.0f, -6.0f, -12.0f, 6.0f };
+    vortex::EQLayout layout;
+    vortex::eq_layout(layout, 4, freq, gain_db);
+    return layout;
+}
+
+// --- Per-mode limits (dB) ---
+
+struct Limits
+{
+    float max_db, rms_db, fr_db;
+};
+
+// Float paths with exact controls
+static const Limits exactLimits[vortex::NUM_MODES] = {
+    { -110.0f, -125.0f, 0.001f },   // LP 6dB
+    {  -90.0f, -105.0f, 0.001f },   // LP 12dB
+    {  -85.0f, -100.0f, 0.001f },   // LP 24dB
+    { -105.0f, -120.0f, 0.001f },   // HP 6dB
+    {  -70.0f,  -90.0f, 0.001f },   // HP 12dB
+    {  -65.0f,  -88.0f, 0.001f },   // HP 24dB
+    {  -85.0f, -100.0f, 0.001f },   // BP
+    {  -80.0f,  -97.0f, 0.001f },   // BP+
+    {  -72.0f,  -93.0f, 0.001f },   // Notch
+    {  -70.0f,  -92.0f, 0.001f },   // Notch+
+    {  -75.0f,  -95.0f, 0.001f },   // AP
+    {  -75.0f,  -95.0f, 0.001f },   // AP+
+    {  -95.0f, -110.0f, 0.001f },   // Ladder
+    {  -70.0f,  -90.0f, 0.001f },   // Formant
+    {  -82.0f, -100.0f, 0.001f },   // Reson
+    {  -90.0f, -100.0f, 0.001f },   // EQ
+};
+
+// Governor levels on the swept cutoff. CV/4 and CV/16 are measured against
+// the reference at full control rate, so these bound the error of stepping
+// the cutoff every 4 or 16 samples (large on the fast "mod" sweep, above all
+// for the narrow bank bands). With a fixed cutoff they must be exact.
+static const Limits cv4Limits[vortex::NUM_MODES] = {
+    {  -54.0f,  -66.0f, 0.001f },   // LP 6dB
+    {  -41.0f,  -54.0f, 0.001f },   // LP 12dB
+    {  -31.0f,  -46.0f, 0.001f },   // LP 24dB
+    {  -49.0f,  -61.0f, 0.001f },   // HP 6dB
+    {  -37.0f,  -50.0f, 0.001f },   // HP 12dB
+    {  -30.0f,  -44.0f, 0.001f },   // HP 24dB
+    {  -37.0f,  -50.0f, 0.001f },   // BP
+    {  -30.0f,  -45.0f, 0.001f },   // BP+
+    {  -44.0f,  -58.0f, 0.001f },   // Notch
+    {  -42.0f,  -57.0f, 0.001f },   // Notch+
+    {  -39.0f,  -52.0f, 0.001f },   // AP
+    {  -31.0f,  -46.0f, 0.001f },   // AP+
+    {  -35.0f,  -49.0f, 0.001f },   // Ladder
+    {   -9.0f,  -31.0f, 0.001f },   // Formant
+    {   -6.0f,  -36.0f, 0.001f },   // Reson
+    {  -90.0f, -100.0f, 0.001f },   // EQ
+};
+
+static const Limits cv16Limits[vortex::NUM_MODES] = {
+    {  -39.0f,  -52.0f, 0.001f },   // LP 6dB
+    {  -27.0f,  -40.0f, 0.001f },   // LP 12dB
+    {  -17.0f,  -32.0f, 0.001f },   // LP 24dB
+    {  -34.0f,  -47.0f, 0.001f },   // HP 6dB
+    {  -23.0f,  -36.0f, 0.001f },   // HP 12dB
+    {  -16.0f,  -30.0f, 0.001f },   // HP 24dB
+    {  -23.0f,  -36.0f, 0.001f },   // BP
+    {  -16.0f,  -31.0f, 0.001f },   // BP+
+    {  -30.0f,  -44.0f, 0.001f },   // Notch
+    {  -28.0f,  -43.0f, 0.001f },   // Notch+
+    {  -25.0f,  -38.0f, 0.001f },   // AP
+    {  -17.0f,  -32.0f, 0.001f },   // AP+
+    {  -21.0f,  -35.0f, 0.001f },   // Ladder
+    {   -4.0f,  -18.0f, 0.001f },   // Formant
+    {   -6.0f,  -23.0f, 0.001f },   // Reson
+    {  -90.0f, -100.0f, 0.001f },   // EQ
+};
+
+// Fast is measured with the cutoff held every 16 samples in both models, so
+// this isolates fast_exp2 (and the cached coefficients it feeds)
+static const Limits fastLimits[vortex::NUM_MODES] = {
+    {  -77.0f,  -91.0f, 0.001f },   // LP 6dB
+    {  -62.0f,  -77.0f, 0.001f },   // LP 12dB
+    {  -54.0f,  -69.0f, 0.001f },   // LP 24dB
+    {  -72.0f,  -86.0f, 0.001f },   // HP 6dB
+    {  -57.0f,  -73.0f, 0.001f },   // HP 12dB
+    {  -51.0f,  -66.0f, 0.001f },   // HP 24dB
+    {  -59.0f,  -73.0f, 0.001f },   // BP
+    {  -52.0f,  -67.0f, 0.001f },   // BP+
+    {  -66.0f,  -80.0f, 0.001f },   // Notch
+    {  -68.0f,  -82.0f, 0.001f },   // Notch+
+    {  -60.0f,  -75.0f, 0.001f },   // AP
+    {  -55.0f,  -70.0f, 0.001f },   // AP+
+    {  -63.0f,  -76.0f, 0.001f },   // Ladder
+    {  -42.0f,  -58.0f, 0.001f },   // Formant
+    {  -48.0f,  -62.0f, 0.001f },   // Reson
+    {  -90.0f, -100.0f, 0.001f },   // EQ
+};
+
+// --- Candidates ---
+// Each runs one mode over in[] with a per-sample cutoff[] and constant
+// damping/drive/mix, like step() does.
+
+struct Candidate
+{
+    const char* name;
+    int hold;       // samples each cutoff value is held for, in both models
+                    // (a candidate may decimate further on its own)
+    void (*run)(int mode, const float* in, const float* cutoff, int n,
+                float drive, float mix, float* out);
+    const Limits* limits;       // per mode: fixed cutoff and response
+    const Limits* sweptLimits;  // per mode: swept cutoff
+};
+
+// Per-sample chain: configure and process every sample
+static void run_per_sample(int mode, const float* in, const float* cutoff, int n,
+                           float drive, float mix, float* out)
+{
+    static vortex::ModeCrossfader xf;
+    xf = vortex::ModeCrossfader();
+    xf.eq = test_eq_layout();
+    xf.set_mode(mode);
+    xf.reset();
+    for (int i = 0; i < n; i++) {
+        vortex::mode_crossfader_configure(xf, kSampleRate, cutoff[i], kDamping);
+        float x = in[i];
+        if (drive > 0.0f)
+            x = vortex::soft_clip(x * (1.0f + drive * 9.0f));
+        float wet = xf.process(x);
+        xf.flush_denormals();
+        out[i] = in[i] * (1.0f - mix) + wet * mix;
+    }
+}
+
+// Fused block kernel, configured once per 24-sample block
+static void run_fused_block(int mode, const float* in, const float* cutoff, int n,
+                            float drive, float mix, float* out)
+{
+    static vortex::ModeCrossfader xf;
+    xf = vortex::ModeCrossfader();
+    xf.eq = test_eq_layout();
+    xf.set_mode(mode);
+    xf.reset();
+    for (int i = 0; i < n; i += 24) {
+        int len = (n - i < 24) ? n - i : 24;
+        vortex::mode_crossfader_configure(xf, kSampleRate, cutoff[i], kDamping);
+        vortex::drive_filter_mix_block(xf, in + i, out + i, len,
+                                       drive, mix, true);
+    }
+}
+
+// The modulated path as step() runs it with CVs patched at a governor
+// quality level, a chunk at a time: the cutoff arrives as V/OCT around a
+// 1 kHz base, and damping, drive and mix through their (zero) CVs, into
+// drive_filter_mix_controls
+static float zeroCV[vortex::CHUNK_SAMPLES];
+
+template <int Level>
+static void run_modulated(int mode, const float* in, const float* cutoff, int n,
+                          float drive, float mix, float* out)
+{
+    int stride = vortex::quality_update_interval(Level);
+    bool fastMath = Level >= vortex::QUALITY_FAST;
+    static vortex::FilterChain chain;
+    chain = vortex::FilterChain();
+    chain.slot[0].eq = test_eq_layout();
+    chain.slot[0].set_mode(mode);
+    chain.slot[0].reset();
+    vortex::ControlBlock ctl;
+    float voct[vortex::CHUNK_SAMPLES];
+    for (int start = 0; start < n; start += vortex::CHUNK_SAMPLES) {
+        int len = n - start;
+        if (len > vortex::CHUNK_SAMPLES) len = vortex::CHUNK_SAMPLES;
+        for (int i = 0; i < len; i++)
+            voct[i] = (float)log2((double)cutoff[start + i] / 1000.0);
+        vortex::modulate_cutoff(ctl.cutoff, voct, NULL, 1000.0f, 0.0f, vortex::FM_EXP,
+                                fastMath, stride, len);
+        vortex::modulate_linear(ctl.damping, zeroCV, kDamping, -0.2f, 0.01f, 0.707f,
+                                stride, len);
+        vortex::modulate_linear(ctl.drive, zeroCV, drive, 0.2f, 0.0f, 1.0f, 1, len);
+        vortex::modulate_linear(ctl.mix, zeroCV, mix, 0.2f, 0.0f, 1.0f, 1, len);
+        vortex::drive_filter_mix_controls(chain, in + start, out + start, len,
+                                          ctl, stride - 1, kSampleRate, true);
+    }
+}
+
+static const Candidate candidates[] = {
+    { "per-sample", 1, run_per_sample, exactLimits, exactLimits },
+    { "fused-block", 24, run_fused_block, exactLimits, exactLimits },
+    { "modulated", 1, run_modulated<vortex::QUALITY_FULL>, exactLimits, exactLimits },
+    { "quality CV/4", 1, run_modulated<vortex::QUALITY_CV4>, exactLimits, cv4Limits },
+    { "quality CV/16", 1, run_modulated<vortex::QUALITY_CV16>, exactLimits, cv16Limits },
+    { "quality Fast", 16, run_modulated<vortex::QUALITY_FAST>, fastLimits, fastLimits },
+};
+
+static const char* modeNames[vortex::NUM_MODES] = {
+    "LP 6dB", "LP 12dB", "LP 24dB", "HP 6dB", "HP 12dB", "HP 24dB",
+    "BP", "BP+", "Notch", "Notch+", "AP", "AP+", "Ladder",
+    "Formant", "Reson", "EQ"
+};
+
+// --- Signals ---
+
+struct Signal
+{
+    const char* name;
+    bool swept;         // cutoff moves
+    float in[kFrames];
+    float cutoff[kFrames];
+};
+
+static Signal signals[3];
+
+static void init_signals()
+{
+    // Log sine sweep 20 Hz - 20 kHz, fixed cutoff
+    Signal& sweep = signals[0];
+    sweep.name = "sweep";
+    sweep.swept = false;
+    double phase = 0.0;
+    for (int i = 0; i < kFrames; i++) {
+        double f = 20.0 * pow(1000.0, (double)i / kFrames);
+        phase += 2.0 * vortex_ref::PI * f / kSampleRate;
+        sweep.in[i] = (float)(0.5 * sin(phase));
+        sweep.cutoff[i] = 1000.0f;
+    }
+
+    // White noise, fixed cutoff
+    Signal& noise = signals[1];
+    noise.name = "noise";
+    noise.swept = false;
+    unsigned seed = 1;
+    for (int i = 0; i < kFrames; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        noise.in[i] = 0.5f * ((float)(seed >> 8) / 8388608.0f - 1.0f);
+        noise.cutoff[i] = 2000.0f;
+    }
+
+    // Noise plus a tone, cutoff swept 100 Hz - 8 kHz at 5 Hz
+    Signal& mod = signals[2];
+    mod.name = "mod";
+    mod.swept = true;
+    for (int i = 0; i < kFrames; i++) {
+        double t = (double)i / kSampleRate;
+        mod.in[i] = noise.in[i] * 0.5f + (float)(0.4 * sin(2.0 * vortex_ref::PI * 110.0 * t));
+        double sweep01 = 0.5 + 0.5 * sin(2.0 * vortex_ref::PI * 5.0 * t);
+        mod.cutoff[i] = (float)(100.0 * pow(80.0, sweep01));
+    }
+}
+
+// --- Measurement ---
+
+static float held[kFrames];
+static float cand[kFrames];
+static double ref[kFrames];
+
+static void run_reference(int mode, const float* in, const float* cutoff, int n,
+                          float drive, float mix, double* out)
+{
+    // Bank modes use the crossfader's default band layouts, EQ the test layout
+    vortex::ModeCrossfader xf;
+    const vortex::BankLayout& bl = *xf.layout(mode);
+    vortex_ref::Layout layout;
+    layout.num = bl.num;
+    for (int i = 0; i < bl.num; i++) {
+        layout.ratio[i] = bl.ratio[i];
+        layout.width[i] = bl.width[i];
+        layout.gain[i] = bl.gain[i];
+    }
+
+    vortex::EQLayout el = test_eq_layout();
+    vortex_ref::EQLayout eq;
+    eq.num = el.num;
+    for (int i = 0; i < el.num; i++) {
+        eq.type[i] = el.type[i] == vortex::F2_LOW_SHELF ? vortex_ref::LOW_SHELF
+                   : el.type[i] == vortex::F2_HIGH_SHELF ? vortex_ref::HIGH_SHELF
+                   : vortex_ref::PEAK;
+        eq.freq[i] = el.freq[i];
+        eq.width[i] = el.width[i];
+        eq.gain[i] = el.gain[i];
+    }
+
+    vortex_ref::Chain chain(mode, layout, eq);
+    for (int i = 0; i < n; i++)
+        out[i] = chain.process(in[i], kSampleRate, cutoff[i], kDamping, drive, mix);
+}
+
+static double to_db(double x)
+{
+    return 20.0 * log10(x > 1e-30 ? x : 1e-30);
+}
+
+// Error of a candidate over one signal: max and rms in dB re reference rms
+static void measure_error(const Candidate& c, int mode, const Signal& sig,
+                          double& max_db, double& rms_db)
+{
+    // Hold the cutoff at the candidate's control rate for both models
+    for (int i = 0; i < kFrames; i++)
+        held[i] = sig.cutoff[i - i % c.hold];
+
+    c.run(mode, sig.in, held, kFrames, kDrive, kMix, cand);
+    run_reference(mode, sig.in, held, kFrames, kDrive, kMix, ref);
+
+    double maxErr = 0.0, sumErr = 0.0, sumRef = 0.0;
+    for (int i = 0; i < kFrames; i++) {
+        double e = fabs((double)cand[i] - ref[i]);
+        if (e > maxErr) maxErr = e;
+        sumErr += e * e;
+        sumRef += ref[i] * ref[i];
+    }
+    double refRms = sqrt(sumRef / kFrames);
+    if (refRms < 1e-6) refRms = 1e-6;
+    max_db = to_db(maxErr / refRms);
+    rms_db = to_db(sqrt(sumErr / kFrames) / refRms);
+}
+
+// Amplitude of the component at freq in x[0..n), by projection
+static double amplitude_at(const double* x, int n, double freq)
+{
+    double s = 0.0, c = 0.0;
+    for (int i = 0; i < n; i++) {
+        double ph = 2.0 * vortex_ref::PI * freq * i / kSampleRate;
+        s += x[i] * sin(ph);
+        c += x[i] * cos(ph);
+    }
+    return 2.0 * sqrt(s * s + c * c) / n;
+}
+
+// Worst magnitude-response deviation (dB) of a candidate vs the reference,
+// filter only (no drive, fully wet), cutoff 1 kHz. The bank modes are also
+// probed at every band centre, where a mis-tuned band shows most.
+static double measure_response(const Candidate& c, int mode)
+{
+    static const int kSettle = 4800;
+    static const int kMeasure = 4800;
+    static float in[kSettle + kMeasure], fc[kSettle + kMeasure];
+    static double candOut[kMeasure];
+    int n = kSettle + kMeasure;
+    double worst = 0.0;
+
+    double probes[20 + vortex::BANK_MAX_BANDS];
+    int numProbes = 0;
+    for (int k = 0; k < 20; k++)
+        probes[numProbes++] = 30.0 * pow(600.0, k / 19.0);   // 30 Hz - 18 kHz
+    if (vortex::mode_is_bank(mode)) {
+        vortex::ModeCrossfader xf;
+        const vortex::BankLayout& bl = *xf.layout(mode);
+        for (int i = 0; i < bl.num; i++)
+            probes[numProbes++] = 1000.0 * bl.ratio[i];
+    }
+
+    for (int k = 0; k < numProbes; k++) {
+        double freq = probes[k];
+        for (int i = 0; i < n; i++) {
+            in[i] = (float)(0.1 * sin(2.0 * vortex_ref::PI * freq * i / kSampleRate));
+            fc[i] = 1000.0f;
+        }
+        c.run(mode, in, fc, n, 0.0f, 1.0f, cand);
+        run_reference(mode, in, fc, n, 0.0f, 1.0f, ref);
+        for (int i = 0; i < kMeasure; i++)
+            candOut[i] = cand[kSettle + i];
+
+        double ar = amplitude_at(ref + kSettle, kMeasure, freq);
+        double ac = amplitude_at(candOut, kMeasure, freq);
+        if (ar < 0.1 * 1e-4)   // more than 80 dB down: not meaningful
+            continue;
+        double dev = fabs(to_db(ac / ar));
+        if (dev > worst) worst = dev;
+    }
+    return worst;
+}
+
+int main()
+{
+    printf("Vortex Reference Comparison\n");
+    printf("===========================\n");
+    printf("error in dB re reference level (limit in brackets)\n");
+
+    init_signals();
+    int failures = 0;
+
+    for (unsigned ci = 0; ci < sizeof(candidates) / sizeof(candidates[0]); ci++) {
+        const Candidate& c = candidates[ci];
+        printf("\n%s:\n", c.name);
+        printf("  %-8s %-6s %14s %14s %14s\n", "mode", "signal", "max", "rms", "fr");
+
+        for (int mode = 0; mode < vortex::NUM_MODES; mode++) {
+            double fr = measure_response(c, mode);
+            bool frFail = fr > c.limits[mode].fr_db;
+
+            for (int si = 0; si < 3; si++) {
+                const Limits& lim = signals[si].swept ? c.sweptLimits[mode]
+                                                      : c.limits[mode];
+                double max_db, rms_db;
+                measure_error(c, mode, signals[si], max_db, rms_db);
+                bool fail = max_db > lim.max_db || rms_db > lim.rms_db;
+                if (si == 0) {
+                    fail = fail || frFail;
+                    printf("  %-8s %-6s %6.1f [%5.0f] %6.1f [%5.0f] %7.5f [%5.3f]%s\n",
+                           modeNames[mode], signals[si].name,
+                           max_db, (double)lim.max_db, rms_db, (double)lim.rms_db,
+                           fr, (double)lim.fr_db, fail ? "  FAIL" : "");
+                } else {
+                    printf("  %-8s %-6s %6.1f [%5.0f] %6.1f [%5.0f]%s\n",
+                           "", signals[si].name,
+                           max_db, (double)lim.max_db, rms_db, (double)lim.rms_db,
+                           fail ? "  FAIL" : "");
+                }
+                if (fail) failures++;
+            }
+        }
+    }
+
+    if (failures) {
+        printf("\n%d limit(s) exceeded\n", failures);
+        return 1;
+    }
+    printf("\nAll modes within limits\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "../vortex.cpp"
+#include "nt_host.h"
+
+// Trace dump tool (host). Build with VORTEX_TRACE=1 (make trace).
+//
+//   trace_dump            run Vortex on a demo patch, request a trace dump
+//                         over SysEx and print the decoded trace as CSV
+//   trace_dump file.syx   decode the dumps captured from the hardware (one
+//                         per Vortex instance)
+//
+// Columns: instance (from the dump header), frame, cutoff (Hz), damping,
+// drive, mode, s0, s1 (filter state, see mode_filter_trace_state).
+
+#if !VORTEX_TRACE
+#error "trace_dump needs VORTEX_TRACE=1"
+#endif
+
+static vortex::TraceFrame frames[vortex::TRACE_FRAMES];
+
+static void print_csv_header()
+{
+    printf( "instance,frame,cutoff,damping,drive,mode,s0,s1\n" );
+}
+
+static void print_csv( uint32_t count, uint8_t instance )
+{
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        const vortex::TraceFrame& f = frames[i];
+        printf( "%u,%u,%.3f,%.5f,%.4f,%d,%.8g,%.8g\n", (unsigned)instance, i, (double)f.cutoff,
+                (double)f.damping, (double)f.drive, (int)f.mode,
+                (double)f.s0, (double)f.s1 );
+    }
+}
+
+static int decode_file( const char* path )
+{
+    FILE* fp = fopen( path, "rb" );
+    if ( !fp )
+    {
+        fprintf( stderr, "can't open %s\n", path );
+        return 1;
+    }
+    static uint8_t msg[kHostMidiOutSize];
+    uint32_t len = (uint32_t)fread( msg, 1, sizeof( msg ), fp );
+    fclose( fp );
+
+    // Each dump runs from its F0 to its F7
+    int dumps = 0;
+    print_csv_header();
+    for ( uint32_t pos = 0; pos < len; ++pos )
+    {
+        if ( msg[pos] != 0xF0 )
+            continue;
+        uint8_t instance = 0;
+        uint32_t count = vortex::trace_decode_sysex( msg + pos, len - pos, frames,
+                                                     vortex::TRACE_FRAMES, &instance );
+        if ( !count )
+            continue;
+        print_csv( count, instance );
+        pos += vortex::TRACE_SYSEX_PREFIX + count * vortex::TRACE_WORDS * 5;
+        ++dumps;
+    }
+    if ( !dumps )
+    {
+        fprintf( stderr, "%s: no Vortex trace dump\n", path );
+        return 1;
+    }
+    return 0;
+}
+
+// Demo patch: noise through LP 24dB with resonance, cutoff swept by a
+// 2 Hz sine on the V/OCT input
+static int run_demo()
+{
+    if ( !nt_host_load() )
+    {
+        fprintf( stderr, "can't load plugin\n" );
+        return 1;
+    }
+    const int numFrames = kHostMaxFrames;
+    nt_host_set_parameter( kParamInput, 1 );
+    nt_host_set_parameter( kParamOutput, 3 );
+    nt_host_set_parameter( kParamCVCutoffVOCT, 2 );
+    nt_host_set_parameter( kParamMode, vortex::MODE_LP24 );
+    nt_host_set_parameter( kParamResonance, 600 );
+    nt_host_set_parameter( kParamTraceEvery, 48 );
+
+    unsigned seed = 1;
+    long t = 0;
+    for ( int block = 0; block < 375; ++block )   // 1 second
+    {
+        float* in = nt_host_bus( 1, numFrames );
+        float* cv = nt_host_bus( 2, numFrames );
+        for ( int i = 0; i < numFrames; ++i, ++t )
+        {
+            seed = seed * 1664525u + 1013904223u;
+            in[i] = 0.5f * ( (float)( seed >> 8 ) / 8388608.0f - 1.0f );
+            cv[i] = 2.0f * sinf( 2.0f * vortex::PI * 2.0f * (float)t / 48000.0f );
+        }
+        nt_host_step( numFrames );
+    }
+
+    // Request the dump and keep stepping until it has been sent
+    static const uint8_t request[] = { 0xF0, 0x7D, 'V', 'T', vortex::TRACE_SYSEX_REQUEST, 0xF7 };
+    nt_host_sysex( request, sizeof( request ) );
+    for ( int block = 0; block < 100000; ++block )
+    {
+        nt_host_step( numFrames );
+        if ( ntHost.midiOutLen && ntHost.midiOut[ntHost.midiOutLen - 1] == 0xF7 )
+            break;
+    }
+
+    uint8_t instance = 0;
+    uint32_t count = vortex::trace_decode_sysex( ntHost.midiOut, ntHost.midiOutLen,
+                                                 frames, vortex::TRACE_FRAMES, &instance );
+    if ( !count )
+    {
+        fprintf( stderr, "no trace dump received\n" );
+        return 1;
+    }
+    print_csv_header();
+    print_csv( count, instance );
+    return 0;
+}
+
+int main( int argc, char** argv )
+{
+    if ( argc > 1 )
+        return decode_file( argv[1] );
+    return run_demo();
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dsp.h"
+
+// Build with internal signal tracing (see TraceBuffer). With 0 the plugin
+// carries no trace state or code at all.
+#ifndef VORTEX_TRACE
+#define VORTEX_TRACE 0
+#endif
+
+namespace vortex {
+
+// ============================================================
+// Signal trace recorder
+// ============================================================
+
+// One trace point: the effective controls and two state variables of the
+// running filter
+struct TraceFrame
+{
+    float cutoff;
+    float damping;
+    float drive;
+    float s0, s1;     // filter state (see mode_filter_trace_state)
+    int32_t mode;
+};
+
+static const int TRACE_WORDS = 6;           // 32-bit words per frame
+static const uint32_t TRACE_FRAMES = 2048;  // ring capacity (power of two)
+
+// Ring buffer of the most recent TRACE_FRAMES trace points, one every
+// `decimation` samples. The frames live in DRAM owned by the plugin.
+struct TraceBuffer
+{
+    TraceFrame* frames;
+    uint32_t head;          // next frame to write
+    uint32_t count;         // frames held (up to TRACE_FRAMES)
+    uint32_t decimation;    // samples per trace point
+    uint32_t phase;         // samples since the last trace point
+    uint8_t instance;       // sent in the dump header (0-127)
+    bool frozen;            // recording paused (e.g. while dumping)
+
+    TraceBuffer() : frames(NULL), head(0), count(0), decimation(1), phase(0),
+                    instance(0), frozen(false) {}
+
+    void clear() { head = count = phase = 0; }
+
+    // i = 0 is the oldest frame held
+    const TraceFrame& frame(uint32_t i) const
+    {
+        return frames[(head - count + i) & (TRACE_FRAMES - 1)];
+    }
+};
+
+// Samples to run, out of the next n, before a trace point is due. Callers
+// split their processing there and call trace_due() after each piece, so
+// every point records the state at its own sample.
+inline int trace_span(const TraceBuffer& t, int n)
+{
+    if (t.frozen)
+        return n;
+    uint32_t left = t.phase < t.decimation ? t.decimation - t.phase : 1;
+    return left < (uint32_t)n ? (int)left : n;
+}
+
+// Account for `samples` samples; true when a trace point is due. The
+// remainder carries over, so points stay exactly `decimation` samples
+// apart whatever the block size. Keeps the cost of a traced build to a
+// counter test on most samples.
+inline bool trace_due(TraceBuffer& t, uint32_t samples)
+{
+    t.phase += samples;
+    if (t.phase < t.decimation)
+        return false;
+    t.phase -= t.decimation;
+    if (t.phase >= t.decimation)    // overran (decimation lowered, or frozen)
+        t.phase %= t.decimation;
+    return !t.frozen;
+}
+
+inline void trace_push(TraceBuffer& t, const TraceFrame& f)
+{
+    t.frames[t.head] = f;
+    t.head = (t.head + 1) & (TRACE_FRAMES - 1);
+    if (t.count < TRACE_FRAMES)
+        ++t.count;
+}
+
+// The two most telling state variables of a mode
+inline void mode_filter_trace_state(const ModeFilter& m, int mode,
+                                    float& s0, float& s1)
+{
+    if (mode_is_first_order(mode))
+    {
+        s0 = m.f1.z;
+        s1 = 0.0f;
+    }
+    else if (mode == MODE_LADDER)
+    {
+        s0 = m.ladder.s[0];
+        s1 = m.ladder.s[3];
+    }
+    else if (mode_is_bank(mode))
+    {
+        s0 = m.bands.z0[0];
+        s1 = m.bands.z1[0];
+    }
+    else if (mode == MODE_EQ)
+    {
+        s0 = m.eq.z0[0];
+        s1 = m.eq.z1[0];
+    }
+    else if (mode_is_cascade(mode))
+    {
+        s0 = m.f2a.z0;
+        s1 = m.f2b.z0;
+    }
+    else
+    {
+        s0 = m.f2a.z0;
+        s1 = m.f2a.z1;
+    }
+}
+
+// --- SysEx transfer ---
+// Request: F0 7D 'V' 'T' 01 F7
+// Dump:    F0 7D 'V' 'T' 02 <instance> <count: 3 septets> <frames> F7
+// Each frame is TRACE_WORDS 32-bit words, each sent as 5 septets, least
+// significant first. instance (0-127) tells apart the dumps of several
+// instances, e.g. the algorithm's slot. 7D is the MIDI non-commercial
+// manufacturer ID.
+
+static const uint8_t TRACE_SYSEX_HEADER[4] = { 0xF0, 0x7D, 'V', 'T' };
+static const uint8_t TRACE_SYSEX_REQUEST = 0x01;
+static const uint8_t TRACE_SYSEX_DUMP = 0x02;
+static const uint32_t TRACE_SYSEX_PREFIX = 9;   // header, command, instance, count
+
+inline uint32_t trace_sysex_size(const TraceBuffer& t)
+{
+    return TRACE_SYSEX_PREFIX + t.count * TRACE_WORDS * 5 + 1;
+}
+
+inline uint32_t trace_frame_word(const TraceFrame& f, int w)
+{
+    union { float f; uint32_t u; } c;
+    switch (w)
+    {
+    case 0: c.f = f.cutoff; break;
+    case 1: c.f = f.damping; break;
+    case 2: c.f = f.drive; break;
+    case 3: c.f = f.s0; break;
+    case 4: c.f = f.s1; break;
+    default: return (uint32_t)f.mode;
+    }
+    return c.u;
+}
+
+// Byte i of the dump message, so it can be sent a few bytes at a time
+inline uint8_t trace_sysex_byte(const TraceBuffer& t, uint32_t i)
+{
+    if (i < 4)
+        return TRACE_SYSEX_HEADER[i];
+    if (i == 4)
+        return TRACE_SYSEX_DUMP;
+    if (i == 5)
+        return t.instance & 0x7F;
+    if (i < TRACE_SYSEX_PREFIX)
+        return (uint8_t)((t.count >> (7 * (i - 6))) & 0x7F);
+    uint32_t k = i - TRACE_SYSEX_PREFIX;
+    if (k >= t.count * TRACE_WORDS * 5)
+        return 0xF7;
+    uint32_t word = k / 5;
+    uint32_t septet = k % 5;
+    uint32_t u = trace_frame_word(t.frame(word / TRACE_WORDS), (int)(word % TRACE_WORDS));
+    return (uint8_t)((u >> (7 * septet)) & 0x7F);
+}
+
+// Decode a dump message into out (host side), and the sending instance into
+// *instance if given. Returns the number of frames, or 0 if msg doesn't
+// start with a complete dump.
+inline uint32_t trace_decode_sysex(const uint8_t* msg, uint32_t len,
+                                   TraceFrame* out, uint32_t max_frames,
+                                   uint8_t* instance = NULL)
+{
+    if (len < TRACE_SYSEX_PREFIX + 1)
+        return 0;
+    for (int i = 0; i < 4; i++)
+        if (msg[i] != TRACE_SYSEX_HEADER[i])
+            return 0;
+    if (msg[4] != TRACE_SYSEX_DUMP)
+        return 0;
+    uint32_t count = msg[6] | (msg[7] << 7) | ((uint32_t)msg[8] << 14);
+    uint32_t end = TRACE_SYSEX_PREFIX + count * TRACE_WORDS * 5;
+    if (len < end + 1 || msg[end] != 0xF7)
+        return 0;
+    // A dump cut short runs into the next message's status bytes
+    for (uint32_t i = 5; i < end; i++)
+        if (msg[i] & 0x80)
+            return 0;
+    if (instance)
+        *instance = msg[5];
+    if (count > max_frames)
+        count = max_frames;
+    const uint8_t* p = msg + TRACE_SYSEX_PREFIX;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        uint32_t words[TRACE_WORDS];
+        for (int w = 0; w < TRACE_WORDS; w++, p += 5)
+            words[w] = p[0] | (p[1] << 7) | (p[2] << 14) | ((uint32_t)p[3] << 21)
+                     | ((uint32_t)p[4] << 28);
+        union { uint32_t u; float f; } c;
+        c.u = words[0]; out[n].cutoff = c.f;
+        c.u = words[1]; out[n].damping = c.f;
+        c.u = words[2]; out[n].drive = c.f;
+        c.u = words[3]; out[n].s0 = c.f;
+        c.u = words[4]; out[n].s1 = c.f;
+        out[n].mode = (int32_t)words[5];
+    }
+    return count;
+}
+
+// Matches an incoming dump request one byte at a time. The leading F0 and
+// trailing F7 are optional, depending on how the host delivers the message.
+struct TraceRequestParser
+{
+    uint8_t pos;    // header bytes matched so far
+    bool valid;     // still matching
+
+    TraceRequestParser() : pos(0), valid(true) {}
+};
+
+// Returns true when `end` completes a valid request
+inline bool trace_parse_request(TraceRequestParser& p, uint8_t byte, bool end)
+{
+    if (p.pos == 0 && byte != 0xF0)
+        p.pos = 1;      // message delivered without F0
+    if (p.valid && byte != 0xF7)
+    {
+        if (p.pos < 4)
+            p.valid = byte == TRACE_SYSEX_HEADER[p.pos];
+        else if (p.pos == 4)
+            p.valid = byte == TRACE_SYSEX_REQUEST;
+        else
+            p.valid = false;
+        ++p.pos;
+    }
+    if (!end)
+        return false;
+    bool ok = p.valid && p.pos == 5;
+    p = TraceRequestParser();
+    return ok;
+}
+
+} // namespace vortex
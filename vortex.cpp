@@ -3,22 +3,62 @@
 #include <string.h>
 #include <distingnt/api.h>
 #include "dsp.h"
+#include "trace.h"
 
 // --- Algorithm struct ---
 
 struct _vortexAlgorithm : public _NT_algorithm
 {
-    // Filter state (two stages for cascaded modes)
-    vortex::Filter1 f1;          // first-order filter (LP6/HP6)
-    vortex::Filter2 f2a, f2b;    // second-order filters (12dB modes + cascaded 24dB)
+    // Filter slots (slot 0 is the main filter), each crossfaded on mode
+    // changes
+    vortex::FilterChain filter;
 
     // Cached parameters (set by parameterChanged)
-    int mode;             // 0-11: LP6/LP12/LP24/HP6/HP12/HP24/BP/BP+/Notch/Notch+/AP/AP+
+    int mode;             // 0-15: LP6/LP12/LP24/HP6/HP12/HP24/BP/BP+/Notch/Notch+/AP/AP+/Ladder/Formant/Reson/EQ
     float cutoffHz;       // 20-20000 Hz
     float damping;        // resonance mapped to damping
     float drive;          // 0.0-1.0
     float mix;            // 0.0-1.0
     float fmDepth;        // -1.0 to 1.0
+    int fmMode;           // 0-2: Exp/Linear/Thru-0
+    float vowel;          // 0.0-4.0: A/E/I/O/U (Formant mode)
+    int bands;            // 3-8 bands (Formant/Reson modes)
+    int slots;            // 1-4 filter slots in use
+    int slotMode[vortex::CHAIN_MAX_SLOTS];  // modes of slots 2-4 (index 1-3)
+    int eqBands;          // 3-4 EQ bands
+    float eqFreq[vortex::EQ_MAX_BANDS];     // Hz, in eq_layout order
+    float eqGainDb[vortex::EQ_MAX_BANDS];   // (low, high, mid, mid 2)
+
+    // Internal modulation sources (LFO and envelope follower)
+    vortex::ModMatrix mods;
+    float lfoRate;        // 0.01-20 Hz
+    float envAttackMs;    // 1-1000 ms
+    float envReleaseMs;   // 1-5000 ms
+
+    int modeOffset;       // Mode CV offset, held with hysteresis between blocks
+    float slotVowel[vortex::CHAIN_MAX_SLOTS];  // vowel each slot's formant
+                                               // layout was built for (-1 = stale)
+
+    // MIDI keyboard tracking
+    uint8_t midiChannel;  // 0-15
+    uint8_t midiNote;     // last note played (held after note off)
+    float keyTrack;       // 0.0-1.0
+    float keyMult;        // cutoff multiplier for midiNote at keyTrack
+
+    // CPU governor
+    vortex::Governor governor;
+    float cpuBudget;      // share of block time, 0.0 = governor off
+
+#if VORTEX_TRACE
+    // Signal trace (frames in DRAM), dumped over SysEx on request
+    vortex::TraceBuffer trace;
+    uint32_t dumpPos;     // next SysEx byte to send
+    uint32_t dumpRequest; // request count the last dump answered
+    uint32_t traceId;     // this instance's dump lock token (never 0)
+    uint32_t lockSeen;    // dump lock progress when last looked at
+    uint32_t lockStalled; // steps the lock has not moved for
+    bool dumpPending;
+#endif
 
     float sampleRate;
 
@@ -30,6 +70,41 @@ struct _vortexAlgorithm : public _NT_algorithm
         drive = 0.0f;
         mix = 1.0f;         // fully wet
         fmDepth = 0.0f;
+        fmMode = vortex::FM_EXP;
+        vowel = 0.0f;
+        bands = 5;
+        slots = 1;
+        for ( int s = 0; s < vortex::CHAIN_MAX_SLOTS; ++s )
+            slotMode[s] = 1;
+        eqBands = 3;
+        for ( int b = 0; b < vortex::EQ_MAX_BANDS; ++b )
+        {
+            eqFreq[b] = 1000.0f;
+            eqGainDb[b] = 0.0f;
+        }
+        lfoRate = 1.0f;
+        envAttackMs = 10.0f;
+        envReleaseMs = 200.0f;
+
+        modeOffset = 0;
+        for ( int s = 0; s < vortex::CHAIN_MAX_SLOTS; ++s )
+            slotVowel[s] = -1.0f;
+
+        midiChannel = 0;
+        midiNote = 60;      // C4: no offset
+        keyTrack = 0.0f;
+        keyMult = 1.0f;
+
+        cpuBudget = 0.0f;
+
+#if VORTEX_TRACE
+        dumpPos = 0;
+        dumpRequest = 0;
+        traceId = 0;
+        lockSeen = 0;
+        lockStalled = 0;
+        dumpPending = false;
+#endif
 
         sampleRate = 48000.0f;
     }
@@ -63,6 +138,60 @@ enum {
     kParamCVDrive,
     kParamCVMix,
 
+    // MIDI (2)
+    kParamMidiChannel,
+    kParamKeyTrack,
+
+    // CPU governor (2)
+    kParamCPUBudget,
+    kParamQuality,
+
+    // Formant / resonator bank (3)
+    kParamVowel,
+    kParamBands,
+    kParamCVVowel,
+
+    // Filter chain (2 + 2 per extra slot)
+    kParamSlots,
+    kParamRouting,
+    kParamSlot2Mode,
+    kParamSlot2Offset,
+    kParamSlot3Mode,
+    kParamSlot3Offset,
+    kParamSlot4Mode,
+    kParamSlot4Offset,
+
+    // FM response (1)
+    kParamFMMode,
+
+    // EQ mode (1 + 2 per band)
+    kParamEQBands,
+    kParamEQLowFreq,
+    kParamEQLowGain,
+    kParamEQMidFreq,
+    kParamEQMidGain,
+    kParamEQMid2Freq,
+    kParamEQMid2Gain,
+    kParamEQHighFreq,
+    kParamEQHighGain,
+
+    // Modulation sources (2 + 2 + 3 depths per source)
+    kParamLFORate,
+    kParamLFOShape,
+    kParamLFOCutoff,
+    kParamLFOResonance,
+    kParamLFOMix,
+    kParamEnvAttack,
+    kParamEnvRelease,
+    kParamEnvCutoff,
+    kParamEnvResonance,
+    kParamEnvMix,
+
+#if VORTEX_TRACE
+    // Trace (1)
+    kParamTraceEvery,
+#endif
+
     kNumParams
 };
 
@@ -73,9 +202,23 @@ static const char* modeStrings[] = {
     "HP 6dB", "HP 12dB", "HP 24dB",
     "BP", "BP+",
     "Notch", "Notch+",
-    "AP", "AP+", NULL
+    "AP", "AP+",
+    "Ladder",
+    "Formant", "Reson",
+    "EQ", NULL
 };
 static const char* versionStrings[] = { VORTEX_VERSION, NULL };
+static const char* qualityStrings[] = { "Full", "CV/4", "CV/16", "Fast", NULL };
+static const char* routingStrings[] = { "Series", "Parallel", NULL };
+static const char* fmModeStrings[] = { "Exp", "Linear", "Thru-0", NULL };
+static const char* lfoShapeStrings[] = { "Sine", "Triangle", "Saw", "Square", "S&H", NULL };
+
+// Mode CV scale: fixed, so patches land on the same modes when modes are
+// added. ±5V spans the original 12 modes.
+static const float kModeCVStepsPerVolt = 2.4f;
+
+// Core clock the CPU budget is measured against
+static const float kCpuClockHz = 600.0e6f;
 
 // --- Parameter definitions ---
 
@@ -85,7 +228,7 @@ static _NT_parameter parameters[] = {
     NT_PARAMETER_AUDIO_OUTPUT_WITH_MODE( "Output", 1, 1 )
 
     // Filter
-    { "Mode",       0,   11,    1, kNT_unitEnum,       0, modeStrings },
+    { "Mode",       0,   vortex::NUM_MODES - 1, 1, kNT_unitEnum, 0, modeStrings },
     { "Cutoff",     0, 1000,  500, kNT_unitHasStrings, 0, NULL },
     { "Resonance",  0, 1000,    0, kNT_unitHasStrings, kNT_scaling10, NULL },
     { "Drive",      0, 1000,    0, kNT_unitPercent,    kNT_scaling10, NULL },
@@ -105,27 +248,114 @@ static _NT_parameter parameters[] = {
     NT_PARAMETER_CV_INPUT( "Mode CV",            0, 0 )
     NT_PARAMETER_CV_INPUT( "Drive CV",           0, 0 )
     NT_PARAMETER_CV_INPUT( "Mix CV",             0, 0 )
+
+    // MIDI
+    { "MIDI Channel", 1,   16,   1, kNT_unitNone,       0, NULL },
+    { "Key Track",    0, 1000,   0, kNT_unitPercent,    kNT_scaling10, NULL },
+
+    // CPU governor (Quality is read-only, set by the governor)
+    { "CPU Budget",   0, 1000,   0, kNT_unitPercent,    kNT_scaling10, NULL },
+    { "Quality",      0, vortex::NUM_QUALITY_LEVELS - 1, 0, kNT_unitEnum, 0, qualityStrings },
+
+    // Formant / resonator bank
+    { "Vowel",        0, 1000,   0, kNT_unitHasStrings, 0, NULL },
+    { "Bands",        3, vortex::BANK_MAX_BANDS, 5, kNT_unitHasStrings, 0, NULL },
+    NT_PARAMETER_CV_INPUT( "Vowel CV",           0, 0 )
+
+    // Filter chain (slot 1 is the main filter)
+    { "Slots",        1, vortex::CHAIN_MAX_SLOTS, 1, kNT_unitNone, 0, NULL },
+    { "Routing",      0, vortex::NUM_CHAIN_ROUTINGS - 1, 0, kNT_unitEnum, 0, routingStrings },
+    { "Slot 2 Mode",  0, vortex::NUM_MODES - 1, 1, kNT_unitEnum, 0, modeStrings },
+    { "Slot 2 Offset", -48, 48,  0, kNT_unitSemitones,  0, NULL },
+    { "Slot 3 Mode",  0, vortex::NUM_MODES - 1, 1, kNT_unitEnum, 0, modeStrings },
+    { "Slot 3 Offset", -48, 48,  0, kNT_unitSemitones,  0, NULL },
+    { "Slot 4 Mode",  0, vortex::NUM_MODES - 1, 1, kNT_unitEnum, 0, modeStrings },
+    { "Slot 4 Offset", -48, 48,  0, kNT_unitSemitones,  0, NULL },
+
+    // FM response
+    { "FM Mode",      0, vortex::NUM_FM_MODES - 1, 0, kNT_unitEnum, 0, fmModeStrings },
+
+    // EQ mode (frequencies on the Cutoff scale)
+    { "EQ Bands",     3, vortex::EQ_MAX_BANDS, 3, kNT_unitNone, 0, NULL },
+    { "Low Freq",     0, 1000,  233, kNT_unitHasStrings, 0, NULL },
+    { "Low Gain",  -240,  240,    0, kNT_unitDb,         kNT_scaling10, NULL },
+    { "Mid Freq",     0, 1000,  566, kNT_unitHasStrings, 0, NULL },
+    { "Mid Gain",  -240,  240,    0, kNT_unitDb,         kNT_scaling10, NULL },
+    { "Mid 2 Freq",   0, 1000,  725, kNT_unitHasStrings, 0, NULL },
+    { "Mid 2 Gain", -240, 240,    0, kNT_unitDb,         kNT_scaling10, NULL },
+    { "High Freq",    0, 1000,  867, kNT_unitHasStrings, 0, NULL },
+    { "High Gain", -240,  240,    0, kNT_unitDb,         kNT_scaling10, NULL },
+
+    // Modulation sources (depths: 100% acts like a 5V CV)
+    { "LFO Rate",     1, 2000,  100, kNT_unitHz,         kNT_scaling100, NULL },
+    { "LFO Shape",    0, vortex::NUM_LFO_SHAPES - 1, 0, kNT_unitEnum, 0, lfoShapeStrings },
+    { "LFO > Cutoff", -1000, 1000, 0, kNT_unitPercent,   kNT_scaling10, NULL },
+    { "LFO > Res",   -1000, 1000,  0, kNT_unitPercent,   kNT_scaling10, NULL },
+    { "LFO > Mix",   -1000, 1000,  0, kNT_unitPercent,   kNT_scaling10, NULL },
+    { "Env Attack",   1, 1000,   10, kNT_unitMs,         0, NULL },
+    { "Env Release",  1, 5000,  200, kNT_unitMs,         0, NULL },
+    { "Env > Cutoff", -1000, 1000, 0, kNT_unitPercent,   kNT_scaling10, NULL },
+    { "Env > Res",   -1000, 1000,  0, kNT_unitPercent,   kNT_scaling10, NULL },
+    { "Env > Mix",   -1000, 1000,  0, kNT_unitPercent,   kNT_scaling10, NULL },
+
+#if VORTEX_TRACE
+    // Trace
+    { "Trace Every",  1, 4800,  48, kNT_unitFrames,     0, NULL },
+#endif
 };
 
 // --- Parameter pages ---
 
 static const uint8_t pageIO[] = { kParamInput, kParamOutput, kParamOutputMode };
 static const uint8_t pageFilter[] = {
-    kParamMode, kParamCutoff, kParamResonance, kParamDrive
+    kParamMode, kParamCutoff, kParamResonance, kParamDrive,
+    kParamVowel, kParamBands
 };
 static const uint8_t pageGlobal[] = {
-    kParamMix, kParamFMDepth, kParamVersion
+    kParamMix, kParamFMDepth, kParamFMMode, kParamVersion, kParamCPUBudget,
+    kParamQuality
 };
 static const uint8_t pageCV[] = {
     kParamCVAudioIn, kParamCVCutoffVOCT, kParamCVCutoffFM,
-    kParamCVResonance, kParamCVMode, kParamCVDrive, kParamCVMix
+    kParamCVResonance, kParamCVMode, kParamCVDrive, kParamCVMix,
+    kParamCVVowel
+};
+static const uint8_t pageMIDI[] = { kParamMidiChannel, kParamKeyTrack };
+static const uint8_t pageChain[] = {
+    kParamSlots, kParamRouting,
+    kParamSlot2Mode, kParamSlot2Offset,
+    kParamSlot3Mode, kParamSlot3Offset,
+    kParamSlot4Mode, kParamSlot4Offset
+};
+static const uint8_t pageEQ[] = {
+    kParamEQBands,
+    kParamEQLowFreq, kParamEQLowGain,
+    kParamEQMidFreq, kParamEQMidGain,
+    kParamEQMid2Freq, kParamEQMid2Gain,
+    kParamEQHighFreq, kParamEQHighGain
 };
+static const uint8_t pageMod[] = {
+    kParamLFORate, kParamLFOShape,
+    kParamLFOCutoff, kParamLFOResonance, kParamLFOMix,
+    kParamEnvAttack, kParamEnvRelease,
+    kParamEnvCutoff, kParamEnvResonance, kParamEnvMix
+};
+#if VORTEX_TRACE
+static const uint8_t pageTrace[] = { kParamTraceEvery };
+#endif
 
 static const _NT_parameterPage pages[] = {
     { .name = "I/O",    .numParams = ARRAY_SIZE(pageIO),      .params = pageIO },
     { .name = "Filter", .numParams = ARRAY_SIZE(pageFilter),  .params = pageFilter },
     { .name = "Global", .numParams = ARRAY_SIZE(pageGlobal),  .params = pageGlobal },
     { .name = "CV",     .numParams = ARRAY_SIZE(pageCV),       .params = pageCV },
+    { .name = "MIDI",   .numParams = ARRAY_SIZE(pageMIDI),     .params = pageMIDI },
+    { .name = "Chain",  .numParams = ARRAY_SIZE(pageChain),    .params = pageChain },
+    { .name = "EQ",     .numParams = ARRAY_SIZE(pageEQ),       .params = pageEQ },
+    { .name = "Mod",    .numParams = ARRAY_SIZE(pageMod),      .params = pageMod },
+#if VORTEX_TRACE
+    { .name = "Trace",  .numParams = ARRAY_SIZE(pageTrace),    .params = pageTrace },
+#endif
 };
 
 static const _NT_parameterPages parameterPages = {
@@ -133,6 +363,26 @@ static const _NT_parameterPages parameterPages = {
     .pages = pages,
 };
 
+#if VORTEX_TRACE
+// midiSysEx has no algorithm argument, so it only counts dump requests;
+// each instance notices a new request in step() and dumps its own trace.
+// One dump is sent at a time, by the instance holding the dump lock, so
+// the SysEx messages never interleave. The holder moves the lock's
+// progress count every step; a lock that stops moving belongs to an
+// instance that was removed mid-dump, and is taken over.
+static vortex::TraceRequestParser traceRequest;
+static uint32_t traceRequests = 0;
+static uint32_t traceNextId = 0;
+static uint32_t traceLockOwner = 0;     // traceId of the holder, 0 = free
+static uint32_t traceLockProgress = 0;
+
+// SysEx bytes sent per step while dumping
+static const uint32_t kTraceDumpBytesPerStep = 64;
+
+// Steps a held dump lock may stand still before it is taken over
+static const uint32_t kTraceLockStallSteps = 16;
+#endif
+
 // --- Lifecycle ---
 
 static void calculateRequirements(
@@ -141,7 +391,11 @@ static void calculateRequirements(
 {
     req.numParameters = ARRAY_SIZE(parameters);
     req.sram = sizeof( _vortexAlgorithm );
+#if VORTEX_TRACE
+    req.dram = vortex::TRACE_FRAMES * sizeof( vortex::TraceFrame );
+#else
     req.dram = 0;
+#endif
     req.dtc = 0;
     req.itc = 0;
 }
@@ -154,11 +408,29 @@ static _NT_algorithm* construct(
     _vortexAlgorithm* alg = new ( ptrs.sram ) _vortexAlgorithm();
     alg->parameters = parameters;
     alg->parameterPages = &parameterPages;
+#if VORTEX_TRACE
+    alg->trace.frames = (vortex::TraceFrame*)ptrs.dram;
+    alg->dumpRequest = traceRequests;
+    if ( ++traceNextId == 0 )
+        ++traceNextId;
+    alg->traceId = traceNextId;
+#endif
     return alg;
 }
 
 // --- Parameter changed ---
 
+// EQ page order (low, mid, mid 2, high) to eq_layout band order
+static const int kEQBandOfPageBand[vortex::EQ_MAX_BANDS] = { 0, 2, 3, 1 };
+
+// Rebuild every slot's EQ layout. The EQ bank recomputes only the bands
+// that changed, the next time it's configured.
+static void updateEQLayout( _vortexAlgorithm* p )
+{
+    for ( int s = 0; s < vortex::CHAIN_MAX_SLOTS; ++s )
+        vortex::eq_layout( p->filter.slot[s].eq, p->eqBands, p->eqFreq, p->eqGainDb );
+}
+
 static void parameterChanged( _NT_algorithm* self, int parameter )
 {
     _vortexAlgorithm* p = (_vortexAlgorithm*)self;
@@ -166,10 +438,8 @@ static void parameterChanged( _NT_algorithm* self, int parameter )
     switch ( parameter )
     {
     case kParamMode:
+        // Applied in step(), which crossfades to the new mode
         p->mode = p->v[parameter];
-        // Reset filter state when mode changes to avoid transients
-        p->f1.reset();
-        p->f2a.reset(); p->f2b.reset();
         break;
     case kParamCutoff:
         p->cutoffHz = vortex::cutoff_param_to_hz( p->v[parameter] );
@@ -186,19 +456,132 @@ static void parameterChanged( _NT_algorithm* self, int parameter )
     case kParamFMDepth:
         p->fmDepth = (float)p->v[parameter] * 0.001f;
         break;
+    case kParamFMMode:
+        p->fmMode = p->v[parameter];
+        break;
+    case kParamMidiChannel:
+        p->midiChannel = p->v[parameter] - 1;  // 1-16 -> 0-15
+        break;
+    case kParamKeyTrack:
+        p->keyTrack = (float)p->v[parameter] * 0.001f;
+        p->keyMult = vortex::keytrack_mult( p->midiNote, p->keyTrack );
+        break;
+    case kParamVowel:
+        p->vowel = (float)p->v[parameter] * 0.004f;  // 0-1000 -> 0-4
+        break;
+    case kParamBands:
+        p->bands = p->v[parameter];
+        // Formant layouts are rebuilt in processBlock(), for the slots using them
+        for ( int s = 0; s < vortex::CHAIN_MAX_SLOTS; ++s )
+        {
+            vortex::harmonic_layout( p->filter.slot[s].harmonics, p->bands );
+            p->slotVowel[s] = -1.0f;
+        }
+        break;
+    case kParamSlots:
+        // Applied in step()
+        p->slots = p->v[parameter];
+        break;
+    case kParamRouting:
+        p->filter.routing = p->v[parameter];
+        break;
+    case kParamSlot2Mode:
+    case kParamSlot3Mode:
+    case kParamSlot4Mode:
+        p->slotMode[1 + ( parameter - kParamSlot2Mode ) / 2] = p->v[parameter];
+        break;
+    case kParamSlot2Offset:
+    case kParamSlot3Offset:
+    case kParamSlot4Offset:
+        p->filter.ratio[1 + ( parameter - kParamSlot2Offset ) / 2] =
+            vortex::voct_to_mult( (float)p->v[parameter] * ( 1.0f / 12.0f ) );
+        break;
+    case kParamEQBands:
+        p->eqBands = p->v[parameter];
+        updateEQLayout( p );
+        break;
+    case kParamEQLowFreq:
+    case kParamEQMidFreq:
+    case kParamEQMid2Freq:
+    case kParamEQHighFreq:
+        p->eqFreq[kEQBandOfPageBand[( parameter - kParamEQLowFreq ) / 2]] =
+            vortex::cutoff_param_to_hz( p->v[parameter] );
+        updateEQLayout( p );
+        break;
+    case kParamEQLowGain:
+    case kParamEQMidGain:
+    case kParamEQMid2Gain:
+    case kParamEQHighGain:
+        p->eqGainDb[kEQBandOfPageBand[( parameter - kParamEQLowGain ) / 2]] =
+            (float)p->v[parameter] * 0.1f;
+        updateEQLayout( p );
+        break;
+    case kParamLFORate:
+        p->lfoRate = (float)p->v[parameter] * 0.01f;
+        break;
+    case kParamLFOShape:
+        p->mods.lfo.shape = p->v[parameter];
+        break;
+    case kParamLFOCutoff:
+    case kParamLFOResonance:
+    case kParamLFOMix:
+        p->mods.depth[vortex::MOD_LFO][parameter - kParamLFOCutoff] =
+            (float)p->v[parameter] * 0.001f;
+        break;
+    case kParamEnvAttack:
+        p->envAttackMs = (float)p->v[parameter];
+        break;
+    case kParamEnvRelease:
+        p->envReleaseMs = (float)p->v[parameter];
+        break;
+    case kParamEnvCutoff:
+    case kParamEnvResonance:
+    case kParamEnvMix:
+        p->mods.depth[vortex::MOD_ENV][parameter - kParamEnvCutoff] =
+            (float)p->v[parameter] * 0.001f;
+        break;
+#if VORTEX_TRACE
+    case kParamTraceEvery:
+        p->trace.decimation = p->v[parameter];
+        break;
+#endif
+    case kParamCPUBudget:
+        p->cpuBudget = (float)p->v[parameter] * 0.001f;
+        break;
+    case kParamQuality:
+        // Read-only: set by the governor, edits are reverted in step()
+        break;
     }
 }
 
 // --- Audio ---
 
-static void step(
-    _NT_algorithm* self,
-    float* busFrames,
-    int numFramesBy4 )
+#if VORTEX_TRACE
+static void traceFrame( _vortexAlgorithm* p, float cutoff, float damping, float drive )
 {
-    _vortexAlgorithm* p = (_vortexAlgorithm*)self;
-    int numFrames = numFramesBy4 * 4;
+    vortex::TraceFrame f;
+    f.cutoff = cutoff;
+    f.damping = damping;
+    f.drive = drive;
+    const vortex::ModeCrossfader& xf = p->filter.slot[0];
+    f.mode = xf.mode;
+    vortex::mode_filter_trace_state( xf.bank[xf.cur], xf.mode, f.s0, f.s1 );
+    vortex::trace_push( p->trace, f );
+}
+#endif
+
+static int clampMode( int mode )
+{
+    if ( mode < 0 ) return 0;
+    if ( mode > vortex::NUM_MODES - 1 ) return vortex::NUM_MODES - 1;
+    return mode;
+}
 
+// Returns the lowest quality level that made this block any cheaper (see
+// governor_update): the levels only change the modulated path, and Fast
+// only its V/OCT and FM conversion
+static int processBlock( _vortexAlgorithm* p, float* busFrames, int numFrames )
+{
     p->sampleRate = (float)NT_globals.sampleRate;
 
     // Get I/O bus pointers
@@ -222,173 +605,280 @@ static void step(
         ? busFrames + ( p->v[kParamCVDrive] - 1 ) * numFrames : NULL;
     const float* cvMix = p->v[kParamCVMix]
         ? busFrames + ( p->v[kParamCVMix] - 1 ) * numFrames : NULL;
+    const float* cvVowel = p->v[kParamCVVowel]
+        ? busFrames + ( p->v[kParamCVVowel] - 1 ) * numFrames : NULL;
 
     float fs = p->sampleRate;
 
-    for ( int i = 0; i < numFrames; ++i )
+    // Base cutoff, offset by the last MIDI note when key tracking
+    float baseCutoff = p->cutoffHz * p->keyMult;
+    if ( baseCutoff < 20.0f ) baseCutoff = 20.0f;
+    if ( baseCutoff > 20000.0f ) baseCutoff = 20000.0f;
+
+    // --- Compute effective modes (once per block) ---
+    // Mode CV is averaged over the block and quantized with hysteresis, so
+    // noise near a step boundary can't flip modes back and forth. It shifts
+    // every slot of the chain by the same number of modes.
+    if ( cvMode )
+    {
+        float sum = 0.0f;
+        for ( int i = 0; i < numFrames; ++i )
+            sum += cvMode[i];
+        float steps = sum / (float)numFrames * kModeCVStepsPerVolt;
+        p->modeOffset = vortex::quantize_hysteresis( steps, p->modeOffset, 0.25f );
+    }
+    else
+    {
+        p->modeOffset = 0;
+    }
+    p->filter.slot[0].set_mode( clampMode( p->mode + p->modeOffset ) );
+    for ( int s = 1; s < vortex::CHAIN_MAX_SLOTS; ++s )
+        p->filter.slot[s].set_mode( clampMode( p->slotMode[s] + p->modeOffset ) );
+    p->filter.set_slots( p->slots );
+
+    // --- Formant layout (once per block) ---
+    // Vowel CV is averaged over the block, 1V per vowel. The layout is built
+    // at most once, and only for active Formant slots whose layout is out of
+    // date. The bank then recomputes only bands whose formants moved.
+    float vowel = p->vowel;
+    if ( cvVowel )
     {
-        // --- Read input ---
-        float input = 0.0f;
-        if ( audioIn )
-            input = audioIn[i];
-        else if ( cvAudioIn )
-            input = cvAudioIn[i];
-        float dry = input;
-
-        // --- Compute effective mode ---
-        int mode = p->mode;
-        if ( cvMode )
+        float sum = 0.0f;
+        for ( int i = 0; i < numFrames; ++i )
+            sum += cvVowel[i];
+        vowel += sum / (float)numFrames;
+        if ( vowel < 0.0f ) vowel = 0.0f;
+        if ( vowel > (float)( vortex::NUM_VOWELS - 1 ) ) vowel = (float)( vortex::NUM_VOWELS - 1 );
+    }
+    vortex::BankLayout formants;
+    bool built = false;
+    for ( int s = 0; s < p->filter.slots; ++s )
+    {
+        vortex::ModeCrossfader& xf = p->filter.slot[s];
+        bool usesFormants = xf.target == vortex::MODE_FORMANT
+                         || xf.mode == vortex::MODE_FORMANT
+                         || ( xf.fade && xf.prev == vortex::MODE_FORMANT );
+        if ( !usesFormants || p->slotVowel[s] == vowel )
+            continue;
+        if ( !built )
         {
-            // CV mode: ±5V range, quantize to 0-11
-            int modeOffset = (int)( cvMode[i] * 2.4f );  // ~5V = 12 steps
-            mode = mode + modeOffset;
-            if ( mode < 0 ) mode = 0;
-            if ( mode > 11 ) mode = 11;
+            vortex::formant_layout( formants, vowel, p->bands );
+            built = true;
         }
+        xf.formants = formants;
+        p->slotVowel[s] = vowel;
+    }
 
-        // --- Compute effective cutoff ---
-        float cutoff = p->cutoffHz;
-
-        // V/OCT modulation (exponential)
-        if ( cvVOCT )
-            cutoff *= vortex::voct_to_mult( cvVOCT[i] );
+    // --- Internal modulation sources ---
+    // They step cutoff, resonance and mix once per chunk, on top of the
+    // parameters and under any CVs
+    const float* in = audioIn ? audioIn : cvAudioIn;
+    bool modSources = vortex::mod_matrix_active( p->mods );
+    if ( modSources )
+    {
+        vortex::lfo_configure( p->mods.lfo, p->lfoRate, fs );
+        vortex::envelope_configure( p->mods.env, p->envAttackMs, p->envReleaseMs, fs );
+    }
 
-        // FM modulation (exponential, with attenuverter depth)
-        if ( cvFM )
-            cutoff *= vortex::voct_to_mult( cvFM[i] * p->fmDepth );
+    // --- Fast path: nothing modulated per sample ---
+    // Configure once (once per chunk with modulation sources) and run the
+    // block through the fused drive/filter/mix kernel, which keeps filter
+    // state in registers across the block.
+    if ( !cvVOCT && !cvFM && !cvResonance && !cvDrive && !cvMix )
+    {
+        int chunk = modSources ? vortex::CHUNK_SAMPLES : numFrames;
+        for ( int start = 0; start < numFrames; start += chunk )
+        {
+            int len = numFrames - start;
+            if ( len > chunk ) len = chunk;
+
+            float cutoff = baseCutoff, damping = p->damping, mix = p->mix;
+            if ( modSources )
+                vortex::mod_matrix_apply( p->mods, in ? in + start : NULL, len,
+                                          cutoff, damping, mix );
+            vortex::filter_chain_configure( p->filter, fs, cutoff, damping );
+#if VORTEX_TRACE
+            // Run up to each due trace point, so it records its own sample
+            for ( int i = start; i < start + len; )
+            {
+                int n = vortex::trace_span( p->trace, start + len - i );
+                vortex::drive_filter_mix_block( p->filter, in ? in + i : NULL, out + i, n,
+                                                p->drive, mix, replace );
+                i += n;
+                if ( vortex::trace_due( p->trace, n ) )
+                    traceFrame( p, cutoff, damping, p->drive );
+            }
+#else
+            vortex::drive_filter_mix_block( p->filter, in ? in + start : NULL, out + start, len,
+                                            p->drive, mix, replace );
+#endif
+        }
+        return vortex::QUALITY_FULL;
+    }
 
-        // Clamp cutoff to safe range
-        if ( cutoff < 20.0f ) cutoff = 20.0f;
-        if ( cutoff > 20000.0f ) cutoff = 20000.0f;
+    // --- Modulated path, a chunk at a time ---
+    // The modulation stage turns the CV buses into per-sample controls, then
+    // the DSP stage runs the chunk from those. Cutoff and resonance (and so
+    // the coefficients) are updated every updateMask + 1 samples, as the
+    // governor allows.
+    int updateMask = vortex::quality_update_interval( p->governor.level ) - 1;
+    bool fastMath = p->governor.level >= vortex::QUALITY_FAST;
+    vortex::ControlBlock ctl;
 
-        // --- Compute effective resonance/damping ---
-        float damping = p->damping;
-        if ( cvResonance )
+    for ( int start = 0; start < numFrames; start += vortex::CHUNK_SAMPLES )
+    {
+        int len = numFrames - start;
+        if ( len > vortex::CHUNK_SAMPLES ) len = vortex::CHUNK_SAMPLES;
+
+        // --- Modulation stage ---
+        float cutoff = baseCutoff, damping = p->damping, mix = p->mix;
+        if ( modSources )
+            vortex::mod_matrix_apply( p->mods, in ? in + start : NULL, len,
+                                      cutoff, damping, mix );
+        vortex::modulate_cutoff( ctl.cutoff,
+                                 cvVOCT ? cvVOCT + start : NULL,
+                                 cvFM ? cvFM + start : NULL,
+                                 cutoff, p->fmDepth, p->fmMode, fastMath,
+                                 updateMask + 1, len );
+        // Resonance CV reduces damping, ±5V -> ±1.0 damping range
+        vortex::modulate_linear( ctl.damping, cvResonance ? cvResonance + start : NULL,
+                                 damping, -0.2f, 0.01f, 0.707f, updateMask + 1, len );
+        // Drive and mix CVs: ±20% of range per volt
+        vortex::modulate_linear( ctl.drive, cvDrive ? cvDrive + start : NULL,
+                                 p->drive, 0.2f, 0.0f, 1.0f, 1, len );
+        vortex::modulate_linear( ctl.mix, cvMix ? cvMix + start : NULL,
+                                 mix, 0.2f, 0.0f, 1.0f, 1, len );
+
+        // --- DSP stage ---
+#if VORTEX_TRACE
+        // Run up to each due trace point, as in the fast path. A point
+        // records the controls in force at its sample: cutoff and damping
+        // from the last coefficient update, drive from the sample itself.
+        for ( int i = 0; i < len; )
         {
-            // CV adds to resonance (reduces damping)
-            float resoAdd = cvResonance[i] * 0.2f;  // ±5V -> ±1.0 damping range
-            damping -= resoAdd;
-            if ( damping < 0.01f ) damping = 0.01f;
-            if ( damping > 0.707f ) damping = 0.707f;
+            int n = vortex::trace_span( p->trace, len - i );
+            vortex::drive_filter_mix_controls_range( p->filter,
+                                                     in ? in + start : NULL, out + start,
+                                                     i, i + n, ctl, updateMask, fs, replace );
+            i += n;
+            if ( vortex::trace_due( p->trace, n ) )
+            {
+                int last = ( i - 1 ) & ~updateMask;
+                traceFrame( p, ctl.cutoff[last], ctl.damping[last], ctl.drive[i - 1] );
+            }
         }
+#else
+        vortex::drive_filter_mix_controls( p->filter, in ? in + start : NULL, out + start, len,
+                                           ctl, updateMask, fs, replace );
+#endif
+    }
+    return ( cvVOCT || cvFM ) ? vortex::QUALITY_FAST : vortex::QUALITY_CV16;
+}
+
+static void step(
+    _NT_algorithm* self,
+    float* busFrames,
+    int numFramesBy4 )
+{
+    _vortexAlgorithm* p = (_vortexAlgorithm*)self;
+    int numFrames = numFramesBy4 * 4;
 
-        // --- Compute effective drive ---
-        float drv = p->drive;
-        if ( cvDrive )
+    uint32_t start = NT_getCpuCycleCount();
+    int lowest = processBlock( p, busFrames, numFrames );
+    uint32_t cycles = NT_getCpuCycleCount() - start;
+
+    // Budget: a share of the block's duration, in core cycles
+    uint32_t budget = (uint32_t)( p->cpuBudget * ( kCpuClockHz / p->sampleRate )
+                                  * (float)numFrames );
+    // Quality is a read-only display: the level is published when it
+    // changes, and an edit (or a value loaded with a preset) is put back.
+    // The level never goes below what this block's path could use.
+    bool changed = vortex::governor_update( p->governor, cycles, budget, lowest );
+    if ( changed || p->v[kParamQuality] != p->governor.level )
+        NT_setParameterFromAudio( NT_algorithmIndex( self ),
+                                  kParamQuality + NT_parameterOffset(),
+                                  p->governor.level );
+
+#if VORTEX_TRACE
+    // Send a requested trace dump a few bytes per block, with recording
+    // paused so the dump is consistent
+    if ( !p->dumpPending && p->dumpRequest != traceRequests )
+    {
+        bool take = traceLockOwner == 0;
+        if ( !take )
         {
-            drv += cvDrive[i] * 0.2f;
-            if ( drv < 0.0f ) drv = 0.0f;
-            if ( drv > 1.0f ) drv = 1.0f;
+            if ( traceLockProgress != p->lockSeen )
+            {
+                p->lockSeen = traceLockProgress;
+                p->lockStalled = 0;
+            }
+            else
+                take = ++p->lockStalled >= kTraceLockStallSteps;
         }
-
-        // --- Compute effective mix ---
-        float mix = p->mix;
-        if ( cvMix )
+        if ( take )
         {
-            mix += cvMix[i] * 0.2f;
-            if ( mix < 0.0f ) mix = 0.0f;
-            if ( mix > 1.0f ) mix = 1.0f;
+            traceLockOwner = p->traceId;
+            p->lockStalled = 0;
+            p->dumpRequest = traceRequests;
+            p->trace.instance = (uint8_t)( NT_algorithmIndex( self ) & 0x7F );
+            p->trace.frozen = true;
+            p->dumpPos = 0;
+            p->dumpPending = true;
         }
-
-        // --- Apply drive (pre-filter saturation) ---
-        float signal = input;
-        if ( drv > 0.0f )
+    }
+    if ( p->dumpPending && traceLockOwner != p->traceId )
+    {
+        // The lock was taken over while this instance wasn't stepping
+        p->dumpPending = false;
+        p->trace.frozen = false;
+    }
+    if ( p->dumpPending )
+    {
+        uint32_t size = vortex::trace_sysex_size( p->trace );
+        for ( uint32_t n = 0; n < kTraceDumpBytesPerStep && p->dumpPos < size; ++n )
+            NT_sendMidiByte( kNT_destinationUSB,
+                             vortex::trace_sysex_byte( p->trace, p->dumpPos++ ) );
+        ++traceLockProgress;
+        if ( p->dumpPos >= size )
         {
-            float driveGain = 1.0f + drv * 9.0f;  // 1x to 10x gain
-            signal = vortex::soft_clip( signal * driveGain );
+            p->dumpPending = false;
+            p->trace.frozen = false;
+            traceLockOwner = 0;
         }
+    }
+#endif
+}
+
+#if VORTEX_TRACE
+static void midiSysEx( uint8_t byte, bool end )
+{
+    if ( vortex::trace_parse_request( traceRequest, byte, end ) )
+        ++traceRequests;
+}
+#endif
 
-        // --- Process through filter ---
-        float wet = 0.0f;
+// --- MIDI ---
 
-        switch ( mode )
-        {
-        case 0: // LP 6dB
-            vortex::filter1_configure_lp( p->f1, fs, cutoff );
-            wet = p->f1.process_lp( signal );
-            break;
-
-        case 1: // LP 12dB
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_LP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_LP );
-            break;
-
-        case 2: // LP 24dB (cascaded)
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_LP );
-            vortex::filter2_configure( p->f2b, fs, cutoff, damping, vortex::F2_LP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_LP );
-            wet = vortex::filter2_process( p->f2b, wet, vortex::F2_LP );
-            break;
-
-        case 3: // HP 6dB
-            vortex::filter1_configure_hp( p->f1, fs, cutoff );
-            wet = p->f1.process_hp( signal );
-            break;
-
-        case 4: // HP 12dB
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_HP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_HP );
-            break;
-
-        case 5: // HP 24dB (cascaded)
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_HP );
-            vortex::filter2_configure( p->f2b, fs, cutoff, damping, vortex::F2_HP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_HP );
-            wet = vortex::filter2_process( p->f2b, wet, vortex::F2_HP );
-            break;
-
-        case 6: // BP
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_BP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_BP );
-            break;
-
-        case 7: // BP+ (cascaded)
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_BP );
-            vortex::filter2_configure( p->f2b, fs, cutoff, damping, vortex::F2_BP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_BP );
-            wet = vortex::filter2_process( p->f2b, wet, vortex::F2_BP );
-            break;
-
-        case 8: // Notch
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_NOTCH );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_NOTCH );
-            break;
-
-        case 9: // Notch+ (cascaded)
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_NOTCH );
-            vortex::filter2_configure( p->f2b, fs, cutoff, damping, vortex::F2_NOTCH );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_NOTCH );
-            wet = vortex::filter2_process( p->f2b, wet, vortex::F2_NOTCH );
-            break;
-
-        case 10: // AP
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_AP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_AP );
-            break;
-
-        case 11: // AP+ (cascaded)
-            vortex::filter2_configure( p->f2a, fs, cutoff, damping, vortex::F2_AP );
-            vortex::filter2_configure( p->f2b, fs, cutoff, damping, vortex::F2_AP );
-            wet = vortex::filter2_process( p->f2a, signal, vortex::F2_AP );
-            wet = vortex::filter2_process( p->f2b, wet, vortex::F2_AP );
-            break;
-        }
+static void midiMessage(
+    _NT_algorithm* self,
+    uint8_t byte0,
+    uint8_t byte1,
+    uint8_t byte2 )
+{
+    _vortexAlgorithm* p = (_vortexAlgorithm*)self;
 
-        // Flush denormals from filter state
-        p->f1.z = vortex::flush_denormal( p->f1.z );
-        p->f2a.z0 = vortex::flush_denormal( p->f2a.z0 );
-        p->f2a.z1 = vortex::flush_denormal( p->f2a.z1 );
-        p->f2b.z0 = vortex::flush_denormal( p->f2b.z0 );
-        p->f2b.z1 = vortex::flush_denormal( p->f2b.z1 );
+    uint8_t status  = byte0 & 0xF0;
+    uint8_t channel = byte0 & 0x0F;
 
-        // --- Dry/wet mix ---
-        float result = dry * ( 1.0f - mix ) + wet * mix;
+    if ( channel != p->midiChannel )
+        return;
 
-        // --- Write output ---
-        if ( replace )
-            out[i] = result;
-        else
-            out[i] += result;
+    // Note On sets the tracking note; it is held after Note Off so the
+    // cutoff doesn't jump back when a key is released
+    if ( status == 0x90 && byte2 > 0 )
+    {
+        p->midiNote = byte1;
+        p->keyMult = vortex::keytrack_mult( byte1, p->keyTrack );
     }
 }
 
@@ -396,8 +886,9 @@ static void step(
 
 static int parameterString( _NT_algorithm* self, int param, int val, char* buff )
 {
-    // Cutoff: display as Hz
-    if ( param == kParamCutoff )
+    // Cutoff and EQ band frequencies: display as Hz
+    if ( param == kParamCutoff || param == kParamEQLowFreq || param == kParamEQMidFreq
+         || param == kParamEQMid2Freq || param == kParamEQHighFreq )
     {
         float hz = vortex::cutoff_param_to_hz( val );
         int len;
@@ -419,6 +910,51 @@ static int parameterString( _NT_algorithm* self, int param, int val, char* buff
         return len;
     }
 
+    // CPU Budget: 0 disables the governor
+    if ( param == kParamCPUBudget && val == 0 )
+    {
+        const char* off = "Off";
+        int len = 0;
+        while ( off[len] ) { buff[len] = off[len]; ++len; }
+        buff[len] = '\0';
+        return len;
+    }
+
+    // Vowel: nearest vowels, with the blend between them
+    if ( param == kParamVowel )
+    {
+        static const char vowels[] = "AEIOU";
+        int v = val / 250;
+        int frac = val % 250;
+        int len = 0;
+        buff[len++] = vowels[v];
+        if ( frac )
+        {
+            buff[len++] = '>';
+            buff[len++] = vowels[v + 1];
+            buff[len++] = ' ';
+            len += NT_intToString( buff + len, frac * 100 / 250 );
+            buff[len++] = '%';
+        }
+        buff[len] = '\0';
+        return len;
+    }
+
+    // Bands: Formant uses at most NUM_FORMANTS of them
+    if ( param == kParamBands )
+    {
+        int len = NT_intToString( buff, val );
+        if ( val > vortex::NUM_FORMANTS )
+        {
+            const char* suffix = " (Formant ";
+            while ( *suffix ) buff[len++] = *suffix++;
+            len += NT_intToString( buff + len, vortex::NUM_FORMANTS );
+            buff[len++] = ')';
+        }
+        buff[len] = '\0';
+        return len;
+    }
+
     // Resonance: display as percentage
     if ( param == kParamResonance )
     {
@@ -448,14 +984,18 @@ static const _NT_factory factory = {
     .step = step,
     .draw = NULL,
     .midiRealtime = NULL,
-    .midiMessage = NULL,
+    .midiMessage = midiMessage,
     .tags = kNT_tagEffect | kNT_tagFilterEQ,
     .hasCustomUi = NULL,
     .customUi = NULL,
     .setupUi = NULL,
     .serialise = NULL,
     .deserialise = NULL,
+#if VORTEX_TRACE
+    .midiSysEx = midiSysEx,
+#else
     .midiSysEx = NULL,
+#endif
     .parameterUiPrefix = NULL,
     .parameterString = parameterString,
 };